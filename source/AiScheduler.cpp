@@ -0,0 +1,201 @@
+// AiScheduler.cpp
+#include "AiScheduler.h"
+#include "EditorState.h"
+#include "PlaySim.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cmath>
+
+void TimerWheel::clear() {
+    for (auto& slot : m_slots)
+        slot.clear();
+    m_pending = 0;
+}
+
+void TimerWheel::reserve(size_t events) {
+    const size_t perSlot = std::max<size_t>(4 * events / kSlots, 8);
+    for (auto& slot : m_slots)
+        slot.reserve(perSlot);
+}
+
+void TimerWheel::schedule(uint32_t dueTick, uint32_t event) {
+    m_slots[dueTick % kSlots].push_back({ dueTick, event });
+    ++m_pending;
+}
+
+void TimerWheel::collect(uint32_t tick, std::vector<uint32_t>& out) {
+    std::vector<Entry>& slot = m_slots[tick % kSlots];
+    for (size_t i = 0; i < slot.size();) {
+        if (slot[i].due == tick) {
+            out.push_back(slot[i].event);
+            slot[i] = slot.back();
+            slot.pop_back();
+            --m_pending;
+        } else {
+            ++i;
+        }
+    }
+}
+
+void TimerWheel::saveState(SnapshotWriter& out) const {
+    out.value(static_cast<uint32_t>(m_pending));
+    for (const auto& slot : m_slots)
+        out.bytes(slot.data(), slot.size() * sizeof(Entry));
+}
+
+void TimerWheel::loadState(SnapshotReader& in) {
+    clear();
+    uint32_t pending = 0;
+    in.value(pending);
+    for (uint32_t i = 0; i < pending; ++i) {
+        Entry e;
+        in.value(e);
+        schedule(e.due, e.event);
+    }
+}
+
+void AiScheduler::clear() {
+    m_wheel.clear();
+    m_due.clear();
+    m_aimX.clear();
+    m_aimY.clear();
+    m_far.clear();
+    m_skip.clear();
+    m_gen.clear();
+    m_cursor = 0;
+    m_tick = 0;
+    m_lastThinks = 0;
+    m_lastFires = 0;
+}
+
+void AiScheduler::reserve(size_t enemies) {
+    m_due.reserve(enemies);
+    m_aimX.reserve(enemies);
+    m_aimY.reserve(enemies);
+    m_far.reserve(enemies);
+    m_skip.reserve(enemies);
+    m_gen.reserve(enemies);
+    m_wheel.reserve(enemies);
+}
+
+void AiScheduler::scheduleFirstShot(const EditorState& state, size_t enemy) {
+    const float cooldown = state.enemies[enemy].cooldown;
+    const float delay = cooldown > 0.0f ? cooldown : 0.0f;
+    m_wheel.schedule(m_tick + static_cast<uint32_t>(std::ceil(delay * kPlayTickRate)), eventFor(enemy));
+}
+
+void AiScheduler::respawn(EditorState& state, size_t enemy) {
+    if (enemy >= m_aimX.size())
+        return; // not picked up yet; update() will
+    ++m_gen[enemy];
+    m_aimX[enemy] = 0.0f;
+    m_aimY[enemy] = 0.0f;
+    m_far[enemy] = 0;
+    m_skip[enemy] = 0;
+    scheduleFirstShot(state, enemy);
+}
+
+void AiScheduler::think(EditorState& state, const Camera3D& player, size_t enemy) {
+    const EnemyWizard& e = state.enemies[enemy];
+    const float dx = player.x - e.x;
+    const float dy = player.y - e.y;
+    const float len = std::sqrt(dx * dx + dy * dy);
+    // Behind the player counts as far: nobody sees those shots coming anyway.
+    const bool behind = std::sin(player.yaw) * dx + std::cos(player.yaw) * dy > 0.0f;
+    m_far[enemy] = (len > kFarDistance || behind) ? 1 : 0;
+    if (len > 0.0001f) {
+        m_aimX[enemy] = dx / len;
+        m_aimY[enemy] = dy / len;
+    }
+}
+
+void AiScheduler::update(EditorState& state, const Camera3D& player) {
+    std::vector<EnemyWizard>& enemies = state.enemies;
+    if (enemies.size() < m_aimX.size())
+        clear(); // the list was rebuilt under us
+    // New enemies fire first after their cooldown, then every kFireCooldownTicks.
+    for (size_t i = m_aimX.size(); i < enemies.size(); ++i) {
+        m_aimX.push_back(0.0f);
+        m_aimY.push_back(0.0f);
+        m_far.push_back(0);
+        m_skip.push_back(0);
+        m_gen.push_back(0);
+        scheduleFirstShot(state, i);
+        think(state, player, i);
+    }
+
+    // Think slice: at most kThinkBudget enemies, carrying on from where the last tick stopped.
+    m_lastThinks = 0;
+    const size_t count = enemies.size();
+    for (size_t visited = 0; visited < count && m_lastThinks < kThinkBudget; ++visited) {
+        const size_t i = m_cursor;
+        m_cursor = (m_cursor + 1) % count;
+        if (!enemies[i].alive)
+            continue;
+        if (m_far[i] && ++m_skip[i] < kFarThinkInterval)
+            continue;
+        m_skip[i] = 0;
+        think(state, player, i);
+        ++m_lastThinks;
+    }
+
+    // Fire events due this tick. Sight for all of them is resolved as one batch first; past
+    // the budget the rest slip to the next tick.
+    m_due.clear();
+    m_wheel.collect(m_tick, m_due);
+    size_t live = 0;
+    for (uint32_t event : m_due) {
+        const uint32_t i = event & 0xFFFFFFu;
+        if (!enemies[i].alive || (event >> 24) != m_gen[i])
+            continue; // dead enemies, and the old occupants of reused slots, drop out of the wheel
+        m_due[live++] = i;
+        state.sight.request(i, enemies[i].x, enemies[i].y);
+    }
+    m_due.resize(live);
+    state.sight.resolve(state, player.x, player.y);
+    m_lastFires = 0;
+    for (uint32_t i : m_due) {
+        if (!state.sight.visible(i)) {
+            m_wheel.schedule(m_tick + kSightRetryTicks, eventFor(i));
+            continue;
+        }
+        if (m_lastFires >= kFireBudget) {
+            m_wheel.schedule(m_tick + 1, eventFor(i));
+            continue;
+        }
+        const EnemyWizard& e = enemies[i];
+        // Near enemies aim where the player is now; far ones make do with the last think.
+        if (!m_far[i])
+            think(state, player, i);
+        if (m_aimX[i] != 0.0f || m_aimY[i] != 0.0f)
+            state.projectiles.spawn(e.x, e.y, e.z, m_aimX[i] * 4.0f, m_aimY[i] * 4.0f, 0.0f, false);
+        m_wheel.schedule(m_tick + kFireCooldownTicks, eventFor(i));
+        ++m_lastFires;
+    }
+    ++m_tick;
+}
+
+void AiScheduler::saveState(SnapshotWriter& out) const {
+    out.value(m_tick);
+    out.value(static_cast<uint32_t>(m_cursor));
+    out.array(m_aimX.data(), m_aimX.size());
+    out.array(m_aimY.data(), m_aimY.size());
+    out.array(m_far.data(), m_far.size());
+    out.array(m_skip.data(), m_skip.size());
+    out.array(m_gen.data(), m_gen.size());
+    m_wheel.saveState(out);
+}
+
+void AiScheduler::loadState(SnapshotReader& in) {
+    uint32_t cursor = 0;
+    in.value(m_tick);
+    in.value(cursor);
+    m_cursor = cursor;
+    in.array(m_aimX);
+    in.array(m_aimY);
+    in.array(m_far);
+    in.array(m_skip);
+    in.array(m_gen);
+    m_wheel.loadState(in);
+    m_due.clear();
+}
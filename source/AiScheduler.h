@@ -0,0 +1,93 @@
+// AiScheduler.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct EditorState;
+struct Camera3D;
+struct SnapshotReader;
+struct SnapshotWriter;
+
+// Hashed timer wheel keyed by tick. Events further out than one revolution stay in their slot
+// and are skipped until their tick comes round.
+class TimerWheel {
+public:
+    static constexpr uint32_t kSlots = 256; // a little over 2 s at 120 Hz
+
+    void clear();
+    // Gives every slot room for several times its fair share of events. Shots bunch up, so a
+    // busy slot can still grow, but only until it reaches its working size.
+    void reserve(size_t events);
+    void schedule(uint32_t dueTick, uint32_t event);
+    // Moves the events due at tick into out (appending). Call once per tick, in order.
+    void collect(uint32_t tick, std::vector<uint32_t>& out);
+    size_t pending() const { return m_pending; }
+
+    // Pending events slot by slot; loading schedules them again in the same order.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+private:
+    struct Entry {
+        uint32_t due;
+        uint32_t event;
+    };
+    std::vector<Entry> m_slots[kSlots];
+    size_t m_pending = 0;
+};
+
+// Drives enemy AI within a fixed per-tick cost. Fire cooldowns are timer-wheel events instead
+// of per-enemy countdowns, and the "think" pass (aim, awareness) visits a bounded slice of
+// enemies per tick in round-robin order. Distant or off-screen enemies think less often.
+// Enemies only fire with line of sight; each tick's due shots are checked as one batch.
+// Enemies are addressed by index into EditorState::enemies, which play mode never reorders.
+// A slot that a spawner reuses gets a new generation, so events left over from its previous
+// occupant are dropped when they come due.
+class AiScheduler {
+public:
+    static constexpr uint32_t kFireCooldownTicks = 240; // 2 s
+    static constexpr uint32_t kSightRetryTicks = 30;    // re-check an enemy that couldn't see the player
+    static constexpr uint32_t kThinkBudget = 32;        // think visits per tick
+    static constexpr uint32_t kFireBudget = 16;         // shots per tick; the rest slip a tick
+    static constexpr uint32_t kFarThinkInterval = 4;    // far enemies think every 4th visit
+    static constexpr float kFarDistance = 20.0f;
+
+    void clear();
+    // Sizes the per-enemy arrays for a pool of this many enemies so play doesn't grow them.
+    void reserve(size_t enemies);
+    // Picks up enemies added since the last tick, then runs one tick of AI.
+    void update(EditorState& state, const Camera3D& player);
+    // Starts over for a reused slot: its old fire event is voided and a new one scheduled.
+    void respawn(EditorState& state, size_t enemy);
+
+    uint32_t tick() const { return m_tick; }
+    uint32_t lastThinks() const { return m_lastThinks; }
+    uint32_t lastFires() const { return m_lastFires; }
+
+    // Tick, think cursor, per-enemy aim and the timer wheel, for play snapshots.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+private:
+    void think(EditorState& state, const Camera3D& player, size_t enemy);
+    // Wheel events carry the slot's generation in the top byte.
+    uint32_t eventFor(size_t enemy) const {
+        return static_cast<uint32_t>(enemy) | (static_cast<uint32_t>(m_gen[enemy]) << 24);
+    }
+    void scheduleFirstShot(const EditorState& state, size_t enemy);
+
+    TimerWheel m_wheel;
+    std::vector<uint32_t> m_due;
+    // Per enemy, parallel to EditorState::enemies.
+    std::vector<float> m_aimX;
+    std::vector<float> m_aimY;
+    std::vector<uint8_t> m_far;
+    std::vector<uint8_t> m_skip;
+    std::vector<uint8_t> m_gen;
+    size_t m_cursor = 0;
+    uint32_t m_tick = 0;
+    uint32_t m_lastThinks = 0;
+    uint32_t m_lastFires = 0;
+};
@@ -0,0 +1,127 @@
+// Blockmap.cpp
+#include "Blockmap.h"
+#include "EditorState.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// Segment vs axis-aligned box: the box must straddle the segment's line.
+bool segmentTouchesBox(float ax, float ay, float bx, float by,
+                       float minX, float minY, float maxX, float maxY) {
+    const float nx = by - ay;
+    const float ny = ax - bx;
+    const float c0 = nx * (minX - ax) + ny * (minY - ay);
+    const float c1 = nx * (maxX - ax) + ny * (minY - ay);
+    const float c2 = nx * (minX - ax) + ny * (maxY - ay);
+    const float c3 = nx * (maxX - ax) + ny * (maxY - ay);
+    const bool anyPos = c0 >= 0.0f || c1 >= 0.0f || c2 >= 0.0f || c3 >= 0.0f;
+    const bool anyNeg = c0 <= 0.0f || c1 <= 0.0f || c2 <= 0.0f || c3 <= 0.0f;
+    return anyPos && anyNeg;
+}
+
+} // namespace
+
+bool Blockmap::cellRange(float minX, float minY, float maxX, float maxY,
+                         int& x0, int& y0, int& x1, int& y1) const {
+    const float inv = 1.0f / m_cellSize;
+    x0 = static_cast<int>(std::floor((minX - m_originX) * inv));
+    y0 = static_cast<int>(std::floor((minY - m_originY) * inv));
+    x1 = static_cast<int>(std::floor((maxX - m_originX) * inv));
+    y1 = static_cast<int>(std::floor((maxY - m_originY) * inv));
+    if (x1 < 0 || y1 < 0 || x0 >= m_width || y0 >= m_height)
+        return false;
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, m_width - 1);
+    y1 = std::min(y1, m_height - 1);
+    return true;
+}
+
+int Blockmap::cellAt(float x, float y) const {
+    if (m_width == 0)
+        return -1;
+    const int cx = static_cast<int>(std::floor((x - m_originX) / m_cellSize));
+    const int cy = static_cast<int>(std::floor((y - m_originY) / m_cellSize));
+    if (cx < 0 || cy < 0 || cx >= m_width || cy >= m_height)
+        return -1;
+    return cy * m_width + cx;
+}
+
+void Blockmap::clear() {
+    m_width = m_height = 0;
+    m_lineStart.clear();
+    m_lineItems.clear();
+    m_lineStamp.clear();
+    m_stamp = 0;
+}
+
+void Blockmap::build(const EditorState& state, float cellSize) {
+    clear();
+    m_cellSize = cellSize;
+
+    const int vertexCount = static_cast<int>(state.vertices.size());
+    auto solidLine = [&](size_t i) {
+        const LineDef& line = state.lines[i];
+        if (line.v1 < 0 || line.v2 < 0 || line.v1 >= vertexCount || line.v2 >= vertexCount)
+            return false;
+        // Portal lines between sectors never block, unless they carry a door.
+        if (i < state.level.lineDoor.size() && state.level.lineDoor[i] >= 0)
+            return true;
+        return !(i < state.level.lineTwoSided.size() && state.level.lineTwoSided[i]);
+    };
+
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    for (const auto& v : state.vertices) {
+        minX = std::min(minX, v.first);
+        minY = std::min(minY, v.second);
+        maxX = std::max(maxX, v.first);
+        maxY = std::max(maxY, v.second);
+    }
+    if (minX > maxX)
+        return;
+
+    m_originX = minX;
+    m_originY = minY;
+    m_width = static_cast<int>((maxX - minX) / cellSize) + 1;
+    m_height = static_cast<int>((maxY - minY) / cellSize) + 1;
+    const size_t cellCount = static_cast<size_t>(m_width) * m_height;
+
+    // Two passes per list: count per cell, prefix-sum into starts, then fill.
+    auto bake = [&](size_t itemCount, auto&& cellsOf, std::vector<uint32_t>& start, std::vector<int32_t>& items) {
+        start.assign(cellCount + 1, 0);
+        for (size_t i = 0; i < itemCount; ++i)
+            cellsOf(i, [&](size_t cell) { ++start[cell + 1]; });
+        for (size_t c = 0; c < cellCount; ++c)
+            start[c + 1] += start[c];
+        items.resize(start[cellCount]);
+        std::vector<uint32_t> cursor(start.begin(), start.end() - 1);
+        for (size_t i = 0; i < itemCount; ++i)
+            cellsOf(i, [&](size_t cell) { items[cursor[cell]++] = static_cast<int32_t>(i); });
+    };
+
+    auto lineCells = [&](size_t i, auto&& emit) {
+        if (!solidLine(i))
+            return;
+        const auto& a = state.vertices[state.lines[i].v1];
+        const auto& b = state.vertices[state.lines[i].v2];
+        int x0, y0, x1, y1;
+        if (!cellRange(std::min(a.first, b.first), std::min(a.second, b.second),
+                       std::max(a.first, b.first), std::max(a.second, b.second), x0, y0, x1, y1))
+            return;
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                const float bx = m_originX + cx * cellSize;
+                const float by = m_originY + cy * cellSize;
+                if (segmentTouchesBox(a.first, a.second, b.first, b.second, bx, by, bx + cellSize, by + cellSize))
+                    emit(static_cast<size_t>(cy) * m_width + cx);
+            }
+        }
+    };
+
+    bake(state.lines.size(), lineCells, m_lineStart, m_lineItems);
+    m_lineStamp.assign(state.lines.size(), 0);
+
+    std::printf("blockmap: %dx%d cells of %.1f, %zu line refs\n",
+                m_width, m_height, cellSize, m_lineItems.size());
+}
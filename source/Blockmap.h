@@ -0,0 +1,122 @@
+// Blockmap.h
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+struct EditorState;
+
+// Uniform grid over the map baked when play mode starts. Each cell lists the solid and door
+// lines overlapping it, so collision only looks at what is near the mover. Whether a door
+// line blocks right now is up to the caller (see lineBlocks).
+class Blockmap {
+public:
+    void build(const EditorState& state, float cellSize = 2.0f);
+    void clear();
+
+    // Calls fn(index) once for each line in the cells overlapped by the box.
+    // fn returns true to stop early.
+    template <typename Fn>
+    void forEachLine(float minX, float minY, float maxX, float maxY, Fn&& fn) {
+        visit(m_lineStart, m_lineItems, m_lineStamp, minX, minY, maxX, maxY, fn);
+    }
+
+    // Calls fn(index) for the lines of each cell the segment (x0, y0) -> (x1, y1) passes
+    // through, nearest cell first. A line spanning several cells is reported once per cell.
+    // Touches no shared state, so any number of threads may walk rays at once.
+    template <typename Fn>
+    void forEachLineOnRay(float x0, float y0, float x1, float y1, Fn&& fn) const {
+        walkRay(m_lineStart, m_lineItems, x0, y0, x1, y1, fn);
+    }
+
+    // Cell index containing (x, y), or -1 outside the grid.
+    int cellAt(float x, float y) const;
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+private:
+    template <typename Fn>
+    void visit(const std::vector<uint32_t>& start, const std::vector<int32_t>& items,
+               std::vector<uint32_t>& stamps, float minX, float minY, float maxX, float maxY, Fn& fn) {
+        if (m_width == 0)
+            return;
+        int x0, y0, x1, y1;
+        if (!cellRange(minX, minY, maxX, maxY, x0, y0, x1, y1))
+            return;
+        // Items span several cells; the stamp (Doom's validcount) reports each one once.
+        if (++m_stamp == 0) {
+            std::fill(m_lineStamp.begin(), m_lineStamp.end(), 0u);
+            m_stamp = 1;
+        }
+        for (int cy = y0; cy <= y1; ++cy) {
+            for (int cx = x0; cx <= x1; ++cx) {
+                const size_t cell = static_cast<size_t>(cy) * m_width + cx;
+                for (uint32_t i = start[cell]; i < start[cell + 1]; ++i) {
+                    const int32_t item = items[i];
+                    if (stamps[item] == m_stamp)
+                        continue;
+                    stamps[item] = m_stamp;
+                    if (fn(item))
+                        return;
+                }
+            }
+        }
+    }
+
+    // Amanatides-Woo grid traversal in cell units.
+    template <typename Fn>
+    void walkRay(const std::vector<uint32_t>& start, const std::vector<int32_t>& items,
+                 float x0, float y0, float x1, float y1, Fn& fn) const {
+        if (m_width == 0)
+            return;
+        const float inv = 1.0f / m_cellSize;
+        const float gx0 = (x0 - m_originX) * inv;
+        const float gy0 = (y0 - m_originY) * inv;
+        const float gx1 = (x1 - m_originX) * inv;
+        const float gy1 = (y1 - m_originY) * inv;
+        int cx = static_cast<int>(std::floor(gx0));
+        int cy = static_cast<int>(std::floor(gy0));
+        const int steps = std::abs(static_cast<int>(std::floor(gx1)) - cx) +
+                          std::abs(static_cast<int>(std::floor(gy1)) - cy);
+        const float dx = gx1 - gx0;
+        const float dy = gy1 - gy0;
+        const int stepX = dx > 0.0f ? 1 : -1;
+        const int stepY = dy > 0.0f ? 1 : -1;
+        const float tDeltaX = dx != 0.0f ? std::fabs(1.0f / dx) : 1e30f;
+        const float tDeltaY = dy != 0.0f ? std::fabs(1.0f / dy) : 1e30f;
+        float tMaxX = dx != 0.0f ? (dx > 0.0f ? cx + 1 - gx0 : gx0 - cx) * tDeltaX : 1e30f;
+        float tMaxY = dy != 0.0f ? (dy > 0.0f ? cy + 1 - gy0 : gy0 - cy) * tDeltaY : 1e30f;
+        for (int n = 0; n <= steps; ++n) {
+            if (cx >= 0 && cy >= 0 && cx < m_width && cy < m_height) {
+                const size_t cell = static_cast<size_t>(cy) * m_width + cx;
+                for (uint32_t i = start[cell]; i < start[cell + 1]; ++i) {
+                    if (fn(items[i]))
+                        return;
+                }
+            }
+            if (tMaxX < tMaxY) {
+                tMaxX += tDeltaX;
+                cx += stepX;
+            } else {
+                tMaxY += tDeltaY;
+                cy += stepY;
+            }
+        }
+    }
+
+    bool cellRange(float minX, float minY, float maxX, float maxY, int& x0, int& y0, int& x1, int& y1) const;
+
+    float m_originX = 0.0f;
+    float m_originY = 0.0f;
+    float m_cellSize = 2.0f;
+    int m_width = 0;
+    int m_height = 0;
+    // Cell lists in CSR form: cell c owns items [start[c], start[c + 1]).
+    std::vector<uint32_t> m_lineStart;
+    std::vector<int32_t> m_lineItems;
+    std::vector<uint32_t> m_lineStamp;
+    uint32_t m_stamp = 0;
+};
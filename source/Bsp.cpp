@@ -0,0 +1,324 @@
+// Bsp.cpp
+#include "Bsp.h"
+#include "Jobs.h"
+#include "Level.h"
+#include "Platform.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace {
+
+constexpr float kEpsilon = 1e-4f;
+// A split costs more than a little imbalance: it adds segs and deepens both subtrees.
+constexpr int64_t kSplitCost = 8;
+constexpr size_t kMaxCandidates = 32;
+// Below this many seg classifications jobs cost more than they save.
+constexpr size_t kParallelWork = 1 << 15;
+
+enum SegSide { SideFront, SideBack, SideSplit };
+
+struct Partition {
+    float x, y, dx, dy;
+};
+
+// Positive on the front (left) side of the partition.
+float sideOf(const Partition& p, float x, float y) {
+    return p.dx * (y - p.y) - p.dy * (x - p.x);
+}
+
+SegSide classify(const Partition& p, const BspSeg& seg, float& splitT) {
+    const float len = std::sqrt(p.dx * p.dx + p.dy * p.dy);
+    const float s1 = sideOf(p, seg.x1, seg.y1) / len;
+    const float s2 = sideOf(p, seg.x2, seg.y2) / len;
+    if (std::fabs(s1) <= kEpsilon && std::fabs(s2) <= kEpsilon) {
+        // Collinear: the side it faces decides.
+        const float dot = (seg.x2 - seg.x1) * p.dx + (seg.y2 - seg.y1) * p.dy;
+        return dot >= 0.0f ? SideFront : SideBack;
+    }
+    if (s1 >= -kEpsilon && s2 >= -kEpsilon)
+        return SideFront;
+    if (s1 <= kEpsilon && s2 <= kEpsilon)
+        return SideBack;
+    splitT = s1 / (s1 - s2);
+    return SideSplit;
+}
+
+Partition partitionFrom(const BspSeg& seg) {
+    return { seg.x1, seg.y1, seg.x2 - seg.x1, seg.y2 - seg.y1 };
+}
+
+// Lower is better; max() marks a candidate that does not divide the set.
+int64_t scorePartition(const std::vector<BspSeg>& segs, const Partition& p) {
+    int64_t front = 0;
+    int64_t back = 0;
+    int64_t splits = 0;
+    for (const BspSeg& seg : segs) {
+        float t = 0.0f;
+        switch (classify(p, seg, t)) {
+            case SideFront: ++front; break;
+            case SideBack:  ++back; break;
+            case SideSplit: ++splits; break;
+        }
+    }
+    if (back == 0 && splits == 0)
+        return std::numeric_limits<int64_t>::max();
+    return splits * kSplitCost + std::llabs(front - back);
+}
+
+void scoreCandidates(const std::vector<BspSeg>& segs, const std::vector<size_t>& candidates,
+                     std::vector<int64_t>& scores) {
+    scores.resize(candidates.size());
+    auto scoreRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            scores[i] = scorePartition(segs, partitionFrom(segs[candidates[i]]));
+    };
+    if (segs.size() * candidates.size() >= kParallelWork) {
+        parallelFor(candidates.size(), 1, scoreRange);
+        return;
+    }
+    scoreRange(0, candidates.size());
+}
+
+// Picks the best dividing seg among candidates; ties go to the earliest so builds are deterministic.
+bool choosePartition(const std::vector<BspSeg>& segs, const std::vector<size_t>& candidates,
+                     std::vector<int64_t>& scores, size_t& best) {
+    scoreCandidates(segs, candidates, scores);
+    int64_t bestScore = std::numeric_limits<int64_t>::max();
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (scores[i] < bestScore) {
+            bestScore = scores[i];
+            best = candidates[i];
+        }
+    }
+    return bestScore != std::numeric_limits<int64_t>::max();
+}
+
+struct BspBuilder {
+    BspTree& tree;
+    std::vector<size_t> candidates;
+    std::vector<int64_t> scores;
+
+    int32_t makeLeaf(const std::vector<BspSeg>& segs) {
+        BspSubsector sub;
+        sub.firstSeg = static_cast<uint32_t>(tree.segs.size());
+        sub.segCount = static_cast<uint32_t>(segs.size());
+        sub.sector = segs.empty() ? -1 : segs.front().sector;
+        tree.segs.insert(tree.segs.end(), segs.begin(), segs.end());
+        tree.subsectors.push_back(sub);
+        return ~static_cast<int32_t>(tree.subsectors.size() - 1);
+    }
+
+    int32_t build(std::vector<BspSeg>& segs) {
+        // Sample evenly spaced candidates on big sets; only if none divides, try every seg.
+        candidates.clear();
+        const size_t stride = std::max<size_t>(1, segs.size() / kMaxCandidates);
+        for (size_t i = 0; i < segs.size(); i += stride)
+            candidates.push_back(i);
+        size_t best = 0;
+        bool found = choosePartition(segs, candidates, scores, best);
+        if (!found && stride > 1) {
+            candidates.clear();
+            for (size_t i = 0; i < segs.size(); ++i)
+                candidates.push_back(i);
+            found = choosePartition(segs, candidates, scores, best);
+        }
+        if (!found)
+            return makeLeaf(segs);
+
+        const Partition p = partitionFrom(segs[best]);
+        std::vector<BspSeg> front;
+        std::vector<BspSeg> back;
+        for (const BspSeg& seg : segs) {
+            float t = 0.0f;
+            switch (classify(p, seg, t)) {
+                case SideFront: front.push_back(seg); break;
+                case SideBack:  back.push_back(seg); break;
+                case SideSplit: {
+                    BspSeg a = seg;
+                    BspSeg b = seg;
+                    a.x2 = b.x1 = seg.x1 + (seg.x2 - seg.x1) * t;
+                    a.y2 = b.y1 = seg.y1 + (seg.y2 - seg.y1) * t;
+                    if (sideOf(p, seg.x1, seg.y1) > 0.0f) {
+                        front.push_back(a);
+                        back.push_back(b);
+                    } else {
+                        back.push_back(a);
+                        front.push_back(b);
+                    }
+                    ++tree.splits;
+                    break;
+                }
+            }
+        }
+        segs.clear();
+        segs.shrink_to_fit();
+
+        const size_t nodeIndex = tree.nodes.size();
+        tree.nodes.push_back({ p.x, p.y, p.dx, p.dy, {0, 0} });
+        const int32_t frontChild = build(front);
+        const int32_t backChild = build(back);
+        tree.nodes[nodeIndex].children[0] = frontChild;
+        tree.nodes[nodeIndex].children[1] = backChild;
+        return static_cast<int32_t>(nodeIndex);
+    }
+};
+
+float nodeSide(const BspNode& node, float x, float y) {
+    return node.dx * (y - node.y) - node.dy * (x - node.x);
+}
+
+struct Ray {
+    float x0, y0, dx, dy;
+};
+
+bool rayNode(const BspTree& tree, int32_t child, const Ray& ray, float t0, float t1,
+             float& hitT, int& hitEdge) {
+    if (child < 0) {
+        const BspSubsector& sub = tree.subsectors[~child];
+        bool hit = false;
+        for (uint32_t i = sub.firstSeg; i < sub.firstSeg + sub.segCount; ++i) {
+            const BspSeg& seg = tree.segs[i];
+            if (seg.portal)
+                continue;
+            const float sx = seg.x2 - seg.x1;
+            const float sy = seg.y2 - seg.y1;
+            const float denom = ray.dx * sy - ray.dy * sx;
+            if (std::fabs(denom) < 1e-12f)
+                continue;
+            const float ox = seg.x1 - ray.x0;
+            const float oy = seg.y1 - ray.y0;
+            const float t = (ox * sy - oy * sx) / denom;
+            const float u = (ox * ray.dy - oy * ray.dx) / denom;
+            if (t >= 0.0f && t <= 1.0f && u >= 0.0f && u <= 1.0f && t < hitT) {
+                hitT = t;
+                hitEdge = seg.edge;
+                hit = true;
+            }
+        }
+        return hit;
+    }
+
+    const BspNode& node = tree.nodes[child];
+    const float s0 = nodeSide(node, ray.x0 + ray.dx * t0, ray.y0 + ray.dy * t0);
+    const float s1 = nodeSide(node, ray.x0 + ray.dx * t1, ray.y0 + ray.dy * t1);
+    if (s0 >= 0.0f && s1 >= 0.0f)
+        return rayNode(tree, node.children[0], ray, t0, t1, hitT, hitEdge);
+    if (s0 < 0.0f && s1 < 0.0f)
+        return rayNode(tree, node.children[1], ray, t0, t1, hitT, hitEdge);
+    // Crosses the partition: the near side holds every hit before the crossing point.
+    const float tSplit = t0 + (t1 - t0) * (s0 / (s0 - s1));
+    const int nearSide = s0 >= 0.0f ? 0 : 1;
+    if (rayNode(tree, node.children[nearSide], ray, t0, tSplit, hitT, hitEdge))
+        return true;
+    return rayNode(tree, node.children[nearSide ^ 1], ray, tSplit, t1, hitT, hitEdge);
+}
+
+void frontToBack(const BspTree& tree, int32_t child, float x, float y,
+                 std::vector<uint8_t>& emitted, std::vector<int>& order) {
+    if (child < 0) {
+        const int sector = tree.subsectors[~child].sector;
+        if (sector >= 0 && !emitted[sector]) {
+            emitted[sector] = 1;
+            order.push_back(sector);
+        }
+        return;
+    }
+    const BspNode& node = tree.nodes[child];
+    const int nearSide = nodeSide(node, x, y) >= 0.0f ? 0 : 1;
+    frontToBack(tree, node.children[nearSide], x, y, emitted, order);
+    frontToBack(tree, node.children[nearSide ^ 1], x, y, emitted, order);
+}
+
+} // namespace
+
+void buildBsp(const Level& level, BspTree& tree) {
+    const uint64_t startNs = PlatformTimeNs();
+    tree.segs.clear();
+    tree.nodes.clear();
+    tree.subsectors.clear();
+    tree.root = 0;
+    tree.splits = 0;
+    tree.sectorCount = level.sectors.size();
+
+    std::vector<BspSeg> segs;
+    segs.reserve(level.edges.size());
+    for (size_t s = 0; s < level.sectors.size(); ++s) {
+        const LevelSector& ls = level.sectors[s];
+        // Sector winding is arbitrary; flip clockwise sectors so the interior is on the left.
+        float area = 0.0f;
+        for (uint32_t e = ls.firstEdge; e < ls.firstEdge + ls.edgeCount; ++e) {
+            const LevelEdge& edge = level.edges[e];
+            if (edge.v1 < 0)
+                continue;
+            area += level.vx[edge.v1] * level.vy[edge.v2] - level.vx[edge.v2] * level.vy[edge.v1];
+        }
+        const bool flip = area < 0.0f;
+        for (uint32_t e = ls.firstEdge; e < ls.firstEdge + ls.edgeCount; ++e) {
+            const LevelEdge& edge = level.edges[e];
+            if (edge.v1 < 0)
+                continue;
+            const int a = flip ? edge.v2 : edge.v1;
+            const int b = flip ? edge.v1 : edge.v2;
+            BspSeg seg;
+            seg.x1 = level.vx[a];
+            seg.y1 = level.vy[a];
+            seg.x2 = level.vx[b];
+            seg.y2 = level.vy[b];
+            if (seg.x1 == seg.x2 && seg.y1 == seg.y2)
+                continue;
+            seg.sector = static_cast<int>(s);
+            seg.edge = static_cast<int>(e);
+            seg.portal = edge.otherSector >= 0;
+            segs.push_back(seg);
+        }
+    }
+
+    if (!segs.empty()) {
+        const size_t inputSegs = segs.size();
+        BspBuilder builder{tree, {}, {}};
+        tree.root = builder.build(segs);
+        tree.buildMs = (PlatformTimeNs() - startNs) * 1e-6;
+        std::printf("bsp: %zu segs -> %zu nodes, %zu subsectors, %zu splits in %.2f ms\n",
+                    inputSegs, tree.nodes.size(), tree.subsectors.size(), tree.splits, tree.buildMs);
+    } else {
+        tree.buildMs = 0.0;
+    }
+}
+
+int bspFindSubsector(const BspTree& tree, float x, float y) {
+    if (tree.subsectors.empty())
+        return -1;
+    int32_t child = tree.root;
+    while (child >= 0) {
+        const BspNode& node = tree.nodes[child];
+        child = node.children[nodeSide(node, x, y) >= 0.0f ? 0 : 1];
+    }
+    return ~child;
+}
+
+bool bspRayCast(const BspTree& tree, float x0, float y0, float x1, float y1,
+                float* hitFraction, int* hitEdge) {
+    if (tree.subsectors.empty())
+        return false;
+    const Ray ray{ x0, y0, x1 - x0, y1 - y0 };
+    float t = 2.0f;
+    int edge = -1;
+    if (!rayNode(tree, tree.root, ray, 0.0f, 1.0f, t, edge))
+        return false;
+    if (hitFraction)
+        *hitFraction = t;
+    if (hitEdge)
+        *hitEdge = edge;
+    return true;
+}
+
+void bspSectorsFrontToBack(const BspTree& tree, float x, float y,
+                           std::vector<uint8_t>& emitted, std::vector<int>& order) {
+    order.clear();
+    emitted.assign(tree.sectorCount, 0);
+    if (tree.subsectors.empty())
+        return;
+    frontToBack(tree, tree.root, x, y, emitted, order);
+}
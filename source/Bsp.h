@@ -0,0 +1,60 @@
+// Bsp.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Level;
+
+// A sector boundary piece, oriented so its front (left) side faces its sector.
+struct BspSeg {
+    float x1 = 0.0f;
+    float y1 = 0.0f;
+    float x2 = 0.0f;
+    float y2 = 0.0f;
+    int sector = -1;
+    int edge = -1; // index into Level::edges
+    bool portal = false;
+};
+
+// Partition line through (x, y) along (dx, dy). children[0] is the front (left) side,
+// children[1] the back; negative values are ~subsectorIndex.
+struct BspNode {
+    float x = 0.0f;
+    float y = 0.0f;
+    float dx = 0.0f;
+    float dy = 0.0f;
+    int32_t children[2] = {0, 0};
+};
+
+// Convex leaf; its segs all belong to one sector.
+struct BspSubsector {
+    uint32_t firstSeg = 0;
+    uint32_t segCount = 0;
+    int sector = -1;
+};
+
+struct BspTree {
+    std::vector<BspSeg> segs;
+    std::vector<BspNode> nodes;
+    std::vector<BspSubsector> subsectors;
+    int32_t root = 0; // node index, or ~subsector for a single-leaf tree; unused while subsectors is empty
+    size_t sectorCount = 0;
+    size_t splits = 0;
+    double buildMs = 0.0;
+};
+
+// Builds the tree from the level's sector edges. Partition candidates are scored in parallel
+// on desktop Linux and serially elsewhere.
+void buildBsp(const Level& level, BspTree& tree);
+// Index of the subsector whose region contains (x, y), or -1 for an empty tree.
+int bspFindSubsector(const BspTree& tree, float x, float y);
+// Walks the segment (x0, y0) -> (x1, y1) front to back and stops at the first solid seg.
+// On a hit returns true with the fraction along the segment and the hit edge.
+bool bspRayCast(const BspTree& tree, float x0, float y0, float x1, float y1,
+                float* hitFraction = nullptr, int* hitEdge = nullptr);
+// Fills order with every sector once, front to back as seen from (x, y). emitted is scratch
+// (one flag per sector) so callers can keep its storage between frames.
+void bspSectorsFrontToBack(const BspTree& tree, float x, float y,
+                           std::vector<uint8_t>& emitted, std::vector<int>& order);
@@ -0,0 +1,97 @@
+// Collision.cpp
+#include "Collision.h"
+#include <cmath>
+
+bool sweepCircleCircle(float x, float y, float dx, float dy, float r,
+                       float cx, float cy, float cr, SweepHit& hit) {
+    const float radius = r + cr;
+    const float ox = x - cx;
+    const float oy = y - cy;
+    const float c = ox * ox + oy * oy - radius * radius;
+    const float b = ox * dx + oy * dy;
+    if (c <= 0.0f) {
+        // Already overlapping: only a hit if still closing in.
+        if (b >= 0.0f || hit.t <= 0.0f)
+            return false;
+        const float len = std::sqrt(ox * ox + oy * oy);
+        hit.t = 0.0f;
+        hit.nx = len > 1e-6f ? ox / len : 0.0f;
+        hit.ny = len > 1e-6f ? oy / len : 1.0f;
+        return true;
+    }
+    const float a = dx * dx + dy * dy;
+    if (a < 1e-12f || b >= 0.0f)
+        return false;
+    const float disc = b * b - a * c;
+    if (disc < 0.0f)
+        return false;
+    const float t = (-b - std::sqrt(disc)) / a;
+    if (t < 0.0f || t > 1.0f || t >= hit.t)
+        return false;
+    hit.t = t;
+    hit.nx = (ox + dx * t) / radius;
+    hit.ny = (oy + dy * t) / radius;
+    return true;
+}
+
+bool sweepCircleSegment(float x, float y, float dx, float dy, float r,
+                        float ax, float ay, float bx, float by, SweepHit& hit) {
+    const float ex = bx - ax;
+    const float ey = by - ay;
+    const float len2 = ex * ex + ey * ey;
+    if (len2 < 1e-12f)
+        return sweepCircleCircle(x, y, dx, dy, r, ax, ay, 0.0f, hit);
+
+    // Start overlap against the closest point of the segment.
+    float u = ((x - ax) * ex + (y - ay) * ey) / len2;
+    u = u < 0.0f ? 0.0f : (u > 1.0f ? 1.0f : u);
+    const float qx = x - (ax + ex * u);
+    const float qy = y - (ay + ey * u);
+    const float dist2 = qx * qx + qy * qy;
+    if (dist2 < r * r) {
+        if (qx * dx + qy * dy >= 0.0f || hit.t <= 0.0f)
+            return false;
+        const float dist = std::sqrt(dist2);
+        hit.t = 0.0f;
+        if (dist > 1e-6f) {
+            hit.nx = qx / dist;
+            hit.ny = qy / dist;
+        } else {
+            const float len = std::sqrt(len2);
+            hit.nx = ey / len;
+            hit.ny = -ex / len;
+        }
+        return true;
+    }
+
+    // Face: the line offset by r towards the mover.
+    const float len = std::sqrt(len2);
+    float nx = ey / len;
+    float ny = -ex / len;
+    float side = (x - ax) * nx + (y - ay) * ny;
+    if (side < 0.0f) {
+        nx = -nx;
+        ny = -ny;
+        side = -side;
+    }
+    const float approach = dx * nx + dy * ny;
+    bool found = false;
+    if (approach < 0.0f) {
+        const float t = (side - r) / -approach;
+        if (t >= 0.0f && t <= 1.0f && t < hit.t) {
+            const float cx = x + dx * t;
+            const float cy = y + dy * t;
+            const float along = ((cx - ax) * ex + (cy - ay) * ey) / len2;
+            if (along >= 0.0f && along <= 1.0f) {
+                hit.t = t;
+                hit.nx = nx;
+                hit.ny = ny;
+                return true;
+            }
+        }
+    }
+    // Missed the face: the end caps are circles of radius 0.
+    found |= sweepCircleCircle(x, y, dx, dy, r, ax, ay, 0.0f, hit);
+    found |= sweepCircleCircle(x, y, dx, dy, r, bx, by, 0.0f, hit);
+    return found;
+}
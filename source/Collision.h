@@ -0,0 +1,18 @@
+// Collision.h
+#pragma once
+
+// First contact of a circle of radius r moving from (x, y) by (dx, dy) during one step.
+// t is the fraction of the step at contact; (nx, ny) points from the obstacle to the mover.
+struct SweepHit {
+    float t = 1.0f;
+    float nx = 0.0f;
+    float ny = 0.0f;
+};
+
+// Both tests only report contacts earlier than hit.t, so calling them over a set of obstacles
+// leaves the earliest one in hit. Movers already touching an obstacle collide at t = 0 only
+// when heading into it, which lets a reflected mover leave the surface.
+bool sweepCircleSegment(float x, float y, float dx, float dy, float r,
+                        float ax, float ay, float bx, float by, SweepHit& hit);
+bool sweepCircleCircle(float x, float y, float dx, float dy, float r,
+                       float cx, float cy, float cr, SweepHit& hit);
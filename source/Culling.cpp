@@ -0,0 +1,102 @@
+// Culling.cpp
+#include "Culling.h"
+#include "Simd.h"
+#include <cmath>
+
+void buildFrustum(const float mvp[16], Frustum& out) {
+    auto row = [&](int r, int c) { return mvp[c * 4 + r]; };
+    for (int i = 0; i < 6; ++i) {
+        const int axis = i / 2;
+        const float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        float* p = out.planes[i];
+        for (int c = 0; c < 4; ++c) {
+            p[c] = row(3, c) + sign * row(axis, c);
+        }
+        float len = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        if (len > 0.0f) {
+            p[0] /= len;
+            p[1] /= len;
+            p[2] /= len;
+            p[3] /= len;
+        }
+    }
+}
+
+size_t cullBoxes(const Frustum& frustum,
+                 const float* minX, const float* minY, const float* minZ,
+                 const float* maxX, const float* maxY, const float* maxZ,
+                 size_t count, uint8_t* visible) {
+    size_t visibleCount = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        simd4f outside = simdZero();
+        for (int p = 0; p < 6; ++p) {
+            const float* pl = frustum.planes[p];
+            // Test the corner furthest along the plane normal; picking the array per plane
+            // keeps the inner loop branch-free across lanes.
+            simd4f px = simdLoad((pl[0] >= 0.0f ? maxX : minX) + i);
+            simd4f py = simdLoad((pl[1] >= 0.0f ? maxY : minY) + i);
+            simd4f pz = simdLoad((pl[2] >= 0.0f ? maxZ : minZ) + i);
+            simd4f d = simdMadd(px, simdSplat(pl[0]),
+                       simdMadd(py, simdSplat(pl[1]),
+                       simdMadd(pz, simdSplat(pl[2]), simdSplat(pl[3]))));
+            outside = simdOr(outside, simdLess(d, simdZero()));
+        }
+        int mask = simdMoveMask(outside);
+        for (int lane = 0; lane < 4; ++lane) {
+            uint8_t v = (mask & (1 << lane)) ? 0 : 1;
+            visible[i + lane] = v;
+            visibleCount += v;
+        }
+    }
+    for (; i < count; ++i) {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; ++p) {
+            const float* pl = frustum.planes[p];
+            float px = pl[0] >= 0.0f ? maxX[i] : minX[i];
+            float py = pl[1] >= 0.0f ? maxY[i] : minY[i];
+            float pz = pl[2] >= 0.0f ? maxZ[i] : minZ[i];
+            inside = pl[0] * px + pl[1] * py + pl[2] * pz + pl[3] >= 0.0f;
+        }
+        visible[i] = inside ? 1 : 0;
+        visibleCount += inside ? 1 : 0;
+    }
+    return visibleCount;
+}
+
+size_t cullSpheres(const Frustum& frustum,
+                   const float* x, const float* y, const float* z, const float* radius,
+                   size_t count, uint8_t* visible) {
+    size_t visibleCount = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        simd4f cx = simdLoad(x + i);
+        simd4f cy = simdLoad(y + i);
+        simd4f cz = simdLoad(z + i);
+        simd4f negR = simdSub(simdZero(), simdLoad(radius + i));
+        simd4f outside = simdZero();
+        for (int p = 0; p < 6; ++p) {
+            const float* pl = frustum.planes[p];
+            simd4f d = simdMadd(cx, simdSplat(pl[0]),
+                       simdMadd(cy, simdSplat(pl[1]),
+                       simdMadd(cz, simdSplat(pl[2]), simdSplat(pl[3]))));
+            outside = simdOr(outside, simdLess(d, negR));
+        }
+        int mask = simdMoveMask(outside);
+        for (int lane = 0; lane < 4; ++lane) {
+            uint8_t v = (mask & (1 << lane)) ? 0 : 1;
+            visible[i + lane] = v;
+            visibleCount += v;
+        }
+    }
+    for (; i < count; ++i) {
+        bool inside = true;
+        for (int p = 0; p < 6 && inside; ++p) {
+            const float* pl = frustum.planes[p];
+            inside = pl[0] * x[i] + pl[1] * y[i] + pl[2] * z[i] + pl[3] >= -radius[i];
+        }
+        visible[i] = inside ? 1 : 0;
+        visibleCount += inside ? 1 : 0;
+    }
+    return visibleCount;
+}
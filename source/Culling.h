@@ -0,0 +1,23 @@
+// Culling.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Six planes (left, right, bottom, top, near, far) as nx, ny, nz, d with normals pointing inward.
+struct Frustum {
+    float planes[6][4];
+};
+
+// Extracts the frustum from a column-major OpenGL view-projection matrix.
+void buildFrustum(const float mvp[16], Frustum& out);
+
+// SoA kernels: write 1 to visible[i] for each box/sphere that intersects the frustum, 0 otherwise.
+// Both return the number of visible entries.
+size_t cullBoxes(const Frustum& frustum,
+                 const float* minX, const float* minY, const float* minZ,
+                 const float* maxX, const float* maxY, const float* maxZ,
+                 size_t count, uint8_t* visible);
+size_t cullSpheres(const Frustum& frustum,
+                   const float* x, const float* y, const float* z, const float* radius,
+                   size_t count, uint8_t* visible);
@@ -1,19 +1,31 @@
 // EditorState.h
 #pragma once
 
+#include <cstdint>
 #include <utility>
 #include <vector>
+#include "AiScheduler.h"
+#include "Blockmap.h"
+#include "EnemyHash.h"
+#include "FlowField.h"
+#include "Level.h"
+#include "LineOfSight.h"
 #include "Mesh3D.h"
 #include "Projectiles.h"
+#include "Triggers.h"
 
 struct LineDef {
     int v1 = -1;
     int v2 = -1;
+    bool door = false; // gets a door slab that opens when the player comes near
 };
 
 struct Sector {
     std::vector<int> vertices;
     bool clockwise = false;
+    float floorHeight = 0.0f;
+    float ceilingHeight = 3.0f;
+    SectorMover mover = SectorMover::None;
 };
 
 struct Camera3D {
@@ -30,24 +42,56 @@ enum class EntityType {
     PlayerStart,
     EnemyWizard,
     ItemPickup,
-    Door
+    Door,
+    Spawner
 };
 
+constexpr uint16_t kMaxSpawnerWave = 64;
+constexpr uint16_t kMaxSpawnerCap = 1024;
+// Seconds between waves; the editor steps within these and loaded maps are clamped to them.
+constexpr float kMinSpawnerInterval = 0.5f;
+constexpr float kMaxSpawnerInterval = 60.0f;
+
 struct Entity {
     float x = 0.0f;
     float y = 0.0f;
     EntityType type = EntityType::PlayerStart;
+    // Spawner only: enemies per wave, seconds between waves, and most alive from it at once.
+    uint16_t waveSize = 4;
+    uint16_t waveCap = 32;
+    float waveInterval = 5.0f;
 };
 
+// Doors stop blocking shots and sight once this far open; walkers wait for fully open.
+constexpr float kDoorOpenEnough = 0.9f;
+
 struct DoorState {
-    float x = 0.0f;
-    float y = 0.0f;
-    float width = 2.0f;
-    float height = 3.0f;
+    int line = -1;         // LineDef the slab sits on
     float progress = 0.0f; // 0 = closed, 1 = fully open
     bool opening = false;
     bool locked = false;
     bool active = true;
+    float prevProgress = 0.0f; // progress before the last tick, for render interpolation
+};
+
+// Play-side motion of a Level mover; offsets are from the moving plane's rest height.
+struct SectorMoverState {
+    float offset = 0.0f;
+    float target = 0.0f;
+    float wait = 0.0f;       // lifts: seconds left at the bottom before rising again
+    float prevOffset = 0.0f; // offset before the last tick, for render interpolation
+};
+
+// Play-side spawner, copied from its entity on entering play mode.
+struct SpawnerState {
+    float x = 0.0f;
+    float y = 0.0f;
+    float interval = 5.0f;
+    float timer = 0.0f;   // seconds until the next wave
+    uint16_t waveSize = 4;
+    uint16_t cap = 32;
+    uint32_t alive = 0;   // its enemies still alive
+    uint32_t spawned = 0; // total so far, which also spreads each wave around the spawner
 };
 
 struct ItemWorld {
@@ -69,11 +113,22 @@ struct EditorState {
     std::vector<LineDef> lines;
     std::vector<Sector> sectors;
     Mesh3D worldMesh;
+    Level level;
     std::vector<Entity> entities;
-    std::vector<EnemyWizard> enemies;
+    std::vector<EnemyWizard> enemies; // play mode keeps dead ones in place; the AI indexes them
+    std::vector<uint32_t> freeEnemies; // dead enemy slots for spawners to reuse, newest last
+    std::vector<SpawnerState> spawners;
+    EnemyHash enemyHash; // live enemies, rebuilt every tick
+    AiScheduler ai;
+    LineOfSight sight;
+    FlowField flow; // chase route to the player, baked with the blockmap
     ProjectileSystem projectiles;
     std::vector<ItemWorld> items;
-    std::vector<DoorState> doors;
+    std::vector<DoorState> doors; // indexed like level.doorLines
+    std::vector<int> activeDoors; // doors animating this tick
+    std::vector<SectorMoverState> movers; // indexed like level.movers
+    TriggerSystem triggers;       // door, item and mover volumes, built on entering play mode
+    Blockmap blockmap; // baked on entering play mode
     int hoveredVertex = -1;
     int selectedVertex = -1;
     int hoveredEntity = -1;
@@ -85,3 +140,9 @@ struct EditorState {
     bool blocking = false;
     float blockFlashTimer = 0.0f;
 };
+
+// Whether blockmap line li stops things right now: walls always, door lines until open past openEnough.
+inline bool lineBlocks(const EditorState& state, int li, float openEnough) {
+    const int door = state.level.lineDoor[li];
+    return door < 0 || (state.doors[door].active && state.doors[door].progress < openEnough);
+}
@@ -0,0 +1,64 @@
+// EnemyHash.cpp
+#include "EnemyHash.h"
+#include "Projectiles.h"
+
+void EnemyHash::clear() {
+    m_bucketStart.clear();
+    m_key.clear();
+    m_enemy.clear();
+    m_x.clear();
+    m_y.clear();
+}
+
+void EnemyHash::reserve(size_t enemies) {
+    size_t buckets = size_t(1) << 6;
+    while (buckets < enemies * 2)
+        buckets <<= 1;
+    m_bucketStart.reserve(buckets + 1);
+    m_fill.reserve(buckets + 1);
+    m_key.reserve(enemies);
+    m_enemy.reserve(enemies);
+    m_x.reserve(enemies);
+    m_y.reserve(enemies);
+    m_enemyBucket.reserve(enemies);
+}
+
+void EnemyHash::build(const std::vector<EnemyWizard>& enemies) {
+    size_t live = 0;
+    for (const EnemyWizard& e : enemies)
+        live += e.alive ? 1 : 0;
+    // Power-of-two bucket count of at least twice the population keeps runs short.
+    int bits = 6;
+    while ((size_t(1) << bits) < live * 2)
+        ++bits;
+    const size_t buckets = size_t(1) << bits;
+    m_shift = 64 - bits;
+
+    m_bucketStart.assign(buckets + 1, 0);
+    m_enemyBucket.resize(enemies.size());
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        if (!enemies[i].alive)
+            continue;
+        const uint32_t bucket = bucketOf(cellKey(cellCoord(enemies[i].x), cellCoord(enemies[i].y)));
+        m_enemyBucket[i] = bucket;
+        ++m_bucketStart[bucket + 1];
+    }
+    for (size_t b = 0; b < buckets; ++b)
+        m_bucketStart[b + 1] += m_bucketStart[b];
+
+    m_key.resize(live);
+    m_enemy.resize(live);
+    m_x.resize(live);
+    m_y.resize(live);
+    m_fill.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        if (!enemies[i].alive)
+            continue;
+        const uint32_t slot = m_fill[m_enemyBucket[i]]++;
+        const EnemyWizard& e = enemies[i];
+        m_key[slot] = cellKey(cellCoord(e.x), cellCoord(e.y));
+        m_enemy[slot] = static_cast<uint32_t>(i);
+        m_x[slot] = e.x;
+        m_y[slot] = e.y;
+    }
+}
@@ -0,0 +1,63 @@
+// EnemyHash.h
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct EnemyWizard;
+
+// Spatial hash of live enemies, rebuilt once per tick. Entries are counting-sorted by bucket
+// into SoA arrays, so a query walks a few short contiguous runs instead of every enemy.
+class EnemyHash {
+public:
+    static constexpr float kCellSize = 1.0f;
+
+    void build(const std::vector<EnemyWizard>& enemies);
+    void clear();
+    // Sizes everything for up to this many enemies so later builds don't allocate.
+    void reserve(size_t enemies);
+
+    // Calls fn(enemyIndex, x, y) for every enemy whose cell overlaps the box, each once, with
+    // its position as of the last build. fn returns true to stop early.
+    template <typename Fn>
+    void forEachInBox(float minX, float minY, float maxX, float maxY, Fn&& fn) const {
+        if (m_bucketStart.empty())
+            return;
+        const int32_t x0 = cellCoord(minX), y0 = cellCoord(minY);
+        const int32_t x1 = cellCoord(maxX), y1 = cellCoord(maxY);
+        for (int32_t cy = y0; cy <= y1; ++cy) {
+            for (int32_t cx = x0; cx <= x1; ++cx) {
+                const uint64_t key = cellKey(cx, cy);
+                const uint32_t bucket = bucketOf(key);
+                for (uint32_t i = m_bucketStart[bucket]; i < m_bucketStart[bucket + 1]; ++i) {
+                    // Other cells share the bucket; the key check also stops them being reported twice.
+                    if (m_key[i] == key && fn(m_enemy[i], m_x[i], m_y[i]))
+                        return;
+                }
+            }
+        }
+    }
+
+    size_t size() const { return m_enemy.size(); }
+
+private:
+    static int32_t cellCoord(float v) { return static_cast<int32_t>(std::floor(v / kCellSize)); }
+    static uint64_t cellKey(int32_t cx, int32_t cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cy)) << 32) | static_cast<uint32_t>(cx);
+    }
+    uint32_t bucketOf(uint64_t key) const {
+        return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> m_shift);
+    }
+
+    std::vector<uint32_t> m_bucketStart; // bucket b owns entries [start[b], start[b + 1])
+    std::vector<uint64_t> m_key;
+    std::vector<uint32_t> m_enemy;
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    // Build scratch, kept so a rebuild doesn't allocate.
+    std::vector<uint32_t> m_enemyBucket;
+    std::vector<uint32_t> m_fill;
+    int m_shift = 64;
+};
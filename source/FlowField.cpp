@@ -0,0 +1,293 @@
+// FlowField.cpp
+#include "FlowField.h"
+#include "EditorState.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+constexpr uint8_t kNoDir = 0xFF;
+constexpr uint16_t kUnreached = 0xFFFF;
+// Neighbour d; odd directions are diagonals, (d + 4) & 7 is the opposite one.
+constexpr int kStepX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+constexpr int kStepY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+bool segmentsCross(float p0x, float p0y, float p1x, float p1y, float ax, float ay, float bx, float by) {
+    const float rx = p1x - p0x;
+    const float ry = p1y - p0y;
+    const float sx = bx - ax;
+    const float sy = by - ay;
+    const float denom = rx * sy - ry * sx;
+    if (std::fabs(denom) < 1e-12f)
+        return false;
+    const float qx = ax - p0x;
+    const float qy = ay - p0y;
+    const float t = (qx * sy - qy * sx) / denom;
+    const float u = (qx * ry - qy * rx) / denom;
+    return t >= 0.0f && t <= 1.0f && u >= 0.0f && u <= 1.0f;
+}
+
+float distanceToSegment(float px, float py, float ax, float ay, float bx, float by) {
+    const float vx = bx - ax;
+    const float vy = by - ay;
+    const float len2 = vx * vx + vy * vy;
+    float t = len2 > 0.0f ? ((px - ax) * vx + (py - ay) * vy) / len2 : 0.0f;
+    t = std::clamp(t, 0.0f, 1.0f);
+    const float dx = ax + vx * t - px;
+    const float dy = ay + vy * t - py;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+} // namespace
+
+FlowField::~FlowField() {
+    clear();
+}
+
+void FlowField::clear() {
+    if (m_pending)
+        jobsWait(m_job);
+    m_pending = false;
+    m_width = m_height = 0;
+    m_open.clear();
+    m_walkable.clear();
+    m_dir.clear();
+    m_nextDir.clear();
+    m_dist.clear();
+    m_queue.clear();
+    m_target = m_nextTarget = -1;
+    m_rebuilds = 0;
+}
+
+int FlowField::cellAt(float x, float y) const {
+    const int cx = static_cast<int>(std::floor((x - m_originX) / kCellSize));
+    const int cy = static_cast<int>(std::floor((y - m_originY) / kCellSize));
+    if (cx < 0 || cy < 0 || cx >= m_width || cy >= m_height)
+        return -1;
+    return cy * m_width + cx;
+}
+
+void FlowField::build(EditorState& state) {
+    clear();
+    const Level& level = state.level;
+    if (level.sectors.empty())
+        return;
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    for (const LevelSector& s : level.sectors) {
+        minX = std::min(minX, s.minX);
+        minY = std::min(minY, s.minY);
+        maxX = std::max(maxX, s.maxX);
+        maxY = std::max(maxY, s.maxY);
+    }
+    if (minX > maxX)
+        return;
+    m_originX = minX;
+    m_originY = minY;
+    m_width = static_cast<int>((maxX - minX) / kCellSize) + 1;
+    m_height = static_cast<int>((maxY - minY) / kCellSize) + 1;
+    const size_t cellCount = static_cast<size_t>(m_width) * m_height;
+    m_walkable.assign(cellCount, 0);
+    m_open.assign(cellCount, 0);
+
+    auto centerX = [&](int cx) { return m_originX + (cx + 0.5f) * kCellSize; };
+    auto centerY = [&](int cy) { return m_originY + (cy + 0.5f) * kCellSize; };
+    size_t walkable = 0;
+    for (int cy = 0; cy < m_height; ++cy) {
+        for (int cx = 0; cx < m_width; ++cx) {
+            const float x = centerX(cx);
+            const float y = centerY(cy);
+            if (findSectorAt(level, x, y) < 0)
+                continue;
+            bool clear = true;
+            // Door lines are routed through as if open; movers wait at them while they are shut.
+            state.blockmap.forEachLine(x - kClearance, y - kClearance, x + kClearance, y + kClearance, [&](int li) {
+                if (level.lineDoor[li] >= 0)
+                    return false;
+                const auto& a = state.vertices[state.lines[li].v1];
+                const auto& b = state.vertices[state.lines[li].v2];
+                clear = distanceToSegment(x, y, a.first, a.second, b.first, b.second) >= kClearance;
+                return !clear;
+            });
+            m_walkable[cy * m_width + cx] = clear ? 1 : 0;
+            walkable += clear ? 1 : 0;
+        }
+    }
+    // Open links: nothing solid between the two centres and a step an enemy can take, which can
+    // differ by direction (dropping off a ledge is fine, climbing it isn't). Walls are tested for
+    // half the directions and mirrored, so each pair is cast once.
+    std::vector<int> cellSector(cellCount);
+    for (int cy = 0; cy < m_height; ++cy) {
+        for (int cx = 0; cx < m_width; ++cx)
+            cellSector[cy * m_width + cx] = locateSector(level, centerX(cx), centerY(cy));
+    }
+    for (int cy = 0; cy < m_height; ++cy) {
+        for (int cx = 0; cx < m_width; ++cx) {
+            const int cell = cy * m_width + cx;
+            for (int d = 0; d < 4; ++d) {
+                const int nx = cx + kStepX[d];
+                const int ny = cy + kStepY[d];
+                if (nx < 0 || ny < 0 || nx >= m_width || ny >= m_height)
+                    continue;
+                const float x0 = centerX(cx), y0 = centerY(cy);
+                const float x1 = centerX(nx), y1 = centerY(ny);
+                bool blocked = false;
+                state.blockmap.forEachLineOnRay(x0, y0, x1, y1, [&](int li) {
+                    if (level.lineDoor[li] >= 0)
+                        return false;
+                    const auto& a = state.vertices[state.lines[li].v1];
+                    const auto& b = state.vertices[state.lines[li].v2];
+                    blocked = segmentsCross(x0, y0, x1, y1, a.first, a.second, b.first, b.second);
+                    return blocked;
+                });
+                if (blocked)
+                    continue;
+                const int next = ny * m_width + nx;
+                if (canStepBetween(level, cellSector[cell], cellSector[next], kMoverHeight))
+                    m_open[cell] |= static_cast<uint8_t>(1u << d);
+                if (canStepBetween(level, cellSector[next], cellSector[cell], kMoverHeight))
+                    m_open[next] |= static_cast<uint8_t>(1u << ((d + 4) & 7));
+            }
+        }
+    }
+    m_dir.assign(cellCount, kNoDir);
+    m_nextDir.assign(cellCount, kNoDir);
+    m_dist.assign(cellCount, kUnreached);
+    m_queue.reserve(cellCount);
+    std::printf("flowfield: %dx%d cells of %.1f, %zu walkable\n", m_width, m_height, kCellSize, walkable);
+}
+
+void FlowField::computeJob(void* data, size_t, size_t) {
+    static_cast<FlowField*>(data)->compute();
+}
+
+void FlowField::compute() {
+    std::fill(m_dist.begin(), m_dist.end(), kUnreached);
+    std::fill(m_nextDir.begin(), m_nextDir.end(), kNoDir);
+    m_queue.clear();
+    if (m_nextTarget < 0)
+        return;
+    // Breadth-first over orthogonal links. The target cell is seeded even when the player stands
+    // too close to a wall for it to count as walkable.
+    m_dist[m_nextTarget] = 0;
+    m_queue.push_back(m_nextTarget);
+    for (size_t head = 0; head < m_queue.size(); ++head) {
+        const int cell = m_queue[head];
+        const int cx = cell % m_width;
+        const int cy = cell / m_width;
+        for (int d = 0; d < 8; d += 2) {
+            const int nx = cx + kStepX[d];
+            const int ny = cy + kStepY[d];
+            if (nx < 0 || ny < 0 || nx >= m_width || ny >= m_height)
+                continue;
+            // Walkers come the other way, from next into cell.
+            const int next = ny * m_width + nx;
+            if (!(m_open[next] & (1u << ((d + 4) & 7))) || !m_walkable[next] || m_dist[next] != kUnreached)
+                continue;
+            m_dist[next] = static_cast<uint16_t>(std::min<int>(m_dist[cell] + 1, kUnreached - 1));
+            m_queue.push_back(next);
+        }
+    }
+    // Each cell steps to its closest open neighbour. Diagonals need both orthogonal links open
+    // so nobody cuts a corner. Unwalkable cells get a direction too, which walks an enemy that
+    // spawned against a wall back out into the open.
+    const int cellCount = m_width * m_height;
+    for (int cell = 0; cell < cellCount; ++cell) {
+        const int cx = cell % m_width;
+        const int cy = cell / m_width;
+        auto sideOpen = [&](int side) {
+            return (m_open[cell] & (1u << side)) && m_walkable[(cy + kStepY[side]) * m_width + cx + kStepX[side]];
+        };
+        uint16_t best = m_dist[cell];
+        uint8_t bestDir = kNoDir;
+        for (int d = 0; d < 8; ++d) {
+            if (!(m_open[cell] & (1u << d)))
+                continue;
+            if ((d & 1) && (!sideOpen(d - 1) || !sideOpen((d + 1) & 7)))
+                continue;
+            const int next = (cy + kStepY[d]) * m_width + cx + kStepX[d];
+            if (m_dist[next] < best) {
+                best = m_dist[next];
+                bestDir = static_cast<uint8_t>(d);
+            }
+        }
+        m_nextDir[cell] = bestDir;
+    }
+}
+
+void FlowField::sync() {
+    if (!m_pending)
+        return;
+    jobsWait(m_job);
+    m_pending = false;
+    m_dir.swap(m_nextDir);
+    m_target = m_nextTarget;
+    ++m_rebuilds;
+}
+
+void FlowField::retarget(float x, float y) {
+    if (m_width == 0)
+        return;
+    const int cell = cellAt(x, y);
+    if (cell < 0 || cell == (m_pending ? m_nextTarget : m_target))
+        return;
+    sync(); // one field in flight at a time
+    m_nextTarget = cell;
+    Job job;
+    job.fn = &FlowField::computeJob;
+    job.data = this;
+    jobsSubmit(job, &m_job);
+    m_pending = true;
+}
+
+void FlowField::saveState(SnapshotWriter& out) const {
+    out.value(m_target);
+    out.value(m_pending ? m_nextTarget : -1);
+}
+
+void FlowField::loadState(SnapshotReader& in) {
+    int target = -1;
+    int pendingTarget = -1;
+    in.value(target);
+    in.value(pendingTarget);
+    sync();
+    if (m_width == 0)
+        return;
+    if (target != m_target) {
+        m_nextTarget = target;
+        compute();
+        m_dir.swap(m_nextDir);
+        m_target = target;
+        ++m_rebuilds;
+    }
+    if (pendingTarget >= 0 && pendingTarget != m_target) {
+        m_nextTarget = pendingTarget;
+        Job job;
+        job.fn = &FlowField::computeJob;
+        job.data = this;
+        jobsSubmit(job, &m_job);
+        m_pending = true;
+    }
+}
+
+bool FlowField::direction(float x, float y, float& dx, float& dy) const {
+    if (m_width == 0)
+        return false;
+    const int cell = cellAt(x, y);
+    if (cell < 0 || m_dir[cell] == kNoDir)
+        return false;
+    const int d = m_dir[cell];
+    const int cx = cell % m_width + kStepX[d];
+    const int cy = cell / m_width + kStepY[d];
+    // Steer for the neighbour's centre rather than along the raw step, so movers stay centred
+    // in corridors.
+    dx = m_originX + (cx + 0.5f) * kCellSize - x;
+    dy = m_originY + (cy + 0.5f) * kCellSize - y;
+    const float len = std::sqrt(dx * dx + dy * dy);
+    if (len < 1e-4f)
+        return false;
+    dx /= len;
+    dy /= len;
+    return true;
+}
@@ -0,0 +1,74 @@
+// FlowField.h
+#pragma once
+
+#include "Jobs.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct EditorState;
+struct SnapshotReader;
+struct SnapshotWriter;
+
+// Shared route to the player for every chasing enemy. A navigation grid is baked with the
+// blockmap, with links that respect wall lines and sector steps; each time the player enters
+// a new cell a breadth-first fill from that cell runs on a worker and leaves one step
+// direction per cell, so an enemy's move is a single lookup.
+// The new field is picked up at the start of the next tick, which keeps play deterministic
+// however long the worker takes.
+class FlowField {
+public:
+    static constexpr float kCellSize = 0.5f;
+    static constexpr float kClearance = 0.3f; // cells with a wall closer than this aren't walkable
+    static constexpr float kMoverHeight = 1.6f; // enemy height, for the step and headroom test
+
+    FlowField() = default;
+    FlowField(const FlowField&) = delete;
+    FlowField& operator=(const FlowField&) = delete;
+    ~FlowField();
+
+    // Bakes the grid from the map's solid lines; the blockmap must already be built.
+    void build(EditorState& state);
+    void clear();
+    // Waits for a field started on an earlier tick and makes it current.
+    void sync();
+    // Starts a field towards (x, y) when that lies in a different cell to the last target.
+    void retarget(float x, float y);
+    // Unit direction from (x, y) along the current field; false with no route or at the target.
+    bool direction(float x, float y, float& dx, float& dy) const;
+
+    // False inside walls and too close to them; points off the grid count as walkable.
+    bool walkable(float x, float y) const {
+        const int cell = cellAt(x, y);
+        return cell < 0 || m_walkable[cell] != 0;
+    }
+
+    // Only the target cells are stored: a field depends on nothing else, so loading recomputes
+    // the current one (if it differs) on this thread and restarts the one that was in flight.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+    size_t cellCount() const { return m_walkable.size(); }
+    uint32_t rebuilds() const { return m_rebuilds; }
+
+private:
+    static void computeJob(void* data, size_t begin, size_t end);
+    void compute();
+    int cellAt(float x, float y) const;
+
+    float m_originX = 0.0f;
+    float m_originY = 0.0f;
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<uint8_t> m_open;     // per cell, bit d set when neighbour d can be reached in a straight line
+    std::vector<uint8_t> m_walkable;
+    std::vector<uint8_t> m_dir;      // current field: step direction per cell, or kNoDir
+    std::vector<uint8_t> m_nextDir;  // written by the worker
+    std::vector<uint16_t> m_dist;    // worker scratch
+    std::vector<int32_t> m_queue;    // worker scratch
+    int m_target = -1;
+    int m_nextTarget = -1;
+    bool m_pending = false;
+    JobCounter m_job;
+    uint32_t m_rebuilds = 0;
+};
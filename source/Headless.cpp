@@ -0,0 +1,293 @@
+// Headless.cpp
+// Play-mode stress runner with no window, renderer or SDL: loads a map, adds extra enemies
+// and projectiles, runs playTick for a fixed number of ticks and reports timings. Built by
+// `make headless`.
+#include "EditorState.h"
+#include "Level.h"
+#include "MapIO.h"
+#include "Platform.h"
+#include "PlaySim.h"
+#include "Replay.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define MAPMAKER_HAVE_RUSAGE 1
+#endif
+
+namespace {
+
+struct HeadlessOptions {
+    uint32_t ticks = 12000; // 100 s of play at 120 Hz
+    uint32_t extraEnemies = 0;
+    uint32_t extraProjectiles = 0;
+    uint32_t spawners = 0;           // extra spawners at random points, 16 a wave every 2 s up to 128
+    uint32_t seed = 1;
+    uint32_t snapshotEvery = 0;      // ticks between checkpoints; 0 takes none
+    const char* mapPath = nullptr;    // take the map from a recording
+    const char* replayPath = nullptr; // take the map and the input from a recording
+    const char* rejectPath = nullptr; // reject table cache: loaded if it matches, else written
+};
+
+void printUsage() {
+    std::printf("usage: mapmaker_headless [--ticks N] [--enemies N] [--projectiles N] [--seed N]\n"
+                "                         [--map session.mmr | --replay session.mmr] [--reject cache.rej]\n"
+                "                         [--snapshots N] [--spawners N]\n");
+}
+
+bool parseOptions(int argc, char** argv, HeadlessOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--ticks") == 0 && hasValue) {
+            opts.ticks = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--enemies") == 0 && hasValue) {
+            opts.extraEnemies = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--projectiles") == 0 && hasValue) {
+            opts.extraProjectiles = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            opts.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--spawners") == 0 && hasValue) {
+            opts.spawners = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--snapshots") == 0 && hasValue) {
+            opts.snapshotEvery = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(arg, "--map") == 0 && hasValue) {
+            opts.mapPath = argv[++i];
+        } else if (std::strcmp(arg, "--replay") == 0 && hasValue) {
+            opts.replayPath = argv[++i];
+        } else if (std::strcmp(arg, "--reject") == 0 && hasValue) {
+            opts.rejectPath = argv[++i];
+        } else {
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+// xorshift32; fixed seed so two runs stress the same layout.
+struct Random {
+    uint32_t s;
+
+    uint32_t next() {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return s;
+    }
+    float unit() { return static_cast<float>(next() >> 8) / static_cast<float>(1u << 24); }
+    float range(float lo, float hi) { return lo + (hi - lo) * unit(); }
+};
+
+// Uniform point inside a random sector, by rejection against the sector's bounds.
+bool randomPointInLevel(const Level& level, Random& rng, float& x, float& y) {
+    if (level.sectors.empty())
+        return false;
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        const int s = static_cast<int>(rng.next() % level.sectors.size());
+        const LevelSector& sector = level.sectors[s];
+        x = rng.range(sector.minX, sector.maxX);
+        y = rng.range(sector.minY, sector.maxY);
+        if (pointInSector(level, s, x, y))
+            return true;
+    }
+    return false;
+}
+
+size_t peakMemoryKb() {
+#ifdef MAPMAKER_HAVE_RUSAGE
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss) / 1024; // bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#else
+    return 0;
+#endif
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    HeadlessOptions opts;
+    if (!parseOptions(argc, argv, opts))
+        return 1;
+    if (!PlatformInit()) {
+        std::printf("PlatformInit failed\n");
+        return 1;
+    }
+
+    static EditorState state;
+    ReplayReader replay;
+    const char* recording = opts.replayPath ? opts.replayPath : opts.mapPath;
+    if (recording) {
+        if (!replay.load(recording, state)) {
+            PlatformShutdown();
+            return 1;
+        }
+    } else {
+        buildDefaultMap(state);
+    }
+
+    const uint64_t setupStartNs = PlatformTimeNs();
+    if (opts.rejectPath)
+        loadReject(opts.rejectPath, state.level.reject);
+    compileLevel(state, state.level);
+    if (opts.rejectPath && state.level.reject.buildMs > 0.0)
+        saveReject(opts.rejectPath, state.level.reject);
+    Random rng{opts.seed ? opts.seed : 1};
+    for (uint32_t i = 0; i < opts.spawners; ++i) {
+        Entity spawner;
+        if (!randomPointInLevel(state.level, rng, spawner.x, spawner.y))
+            break;
+        spawner.type = EntityType::Spawner;
+        spawner.waveSize = 16;
+        spawner.waveCap = 128;
+        spawner.waveInterval = 2.0f;
+        state.entities.push_back(spawner);
+    }
+    Camera3D player;
+    playBegin(state, player);
+    if (recording)
+        player = replay.startPose();
+
+    for (uint32_t i = 0; i < opts.extraEnemies; ++i) {
+        float x, y;
+        if (!randomPointInLevel(state.level, rng, x, y))
+            break;
+        // Staggered cooldowns so the extra wizards don't all fire on the same tick.
+        state.enemies.push_back({ x, y, 1.4f, rng.range(0.0f, 2.0f), true });
+    }
+    for (uint32_t i = 0; i < opts.extraProjectiles; ++i) {
+        float x, y;
+        if (!randomPointInLevel(state.level, rng, x, y))
+            break;
+        const float angle = rng.range(0.0f, 6.2831853f);
+        if (!state.projectiles.spawn(x, y, 1.4f, std::cos(angle) * 4.0f, std::sin(angle) * 4.0f, 0.0f, false))
+            break;
+    }
+    const double setupMs = (PlatformTimeNs() - setupStartNs) * 1e-6;
+    std::printf("headless: %zu sectors, %zu enemies, %zu projectiles, setup %.2f ms\n",
+                state.level.sectors.size(), state.enemies.size(), state.projectiles.count, setupMs);
+
+    // Without a recording the player stands still holding block and turns slowly, so shots keep
+    // bouncing instead of ending the run on the first hit.
+    PlayInput input;
+    input.block = true;
+
+    // Checkpoints are taken outside the tick timings and reported on their own.
+    static SnapshotRing snapshots;
+    std::vector<uint32_t> captureNs;
+    if (opts.snapshotEvery > 0) {
+        snapshots.reserve(kSnapshotArenaBytes);
+        captureNs.reserve(opts.ticks / opts.snapshotEvery + 1);
+    }
+
+    std::vector<uint32_t> tickNs;
+    tickNs.reserve(opts.ticks);
+    size_t peakProjectiles = state.projectiles.count;
+    const uint64_t runStartNs = PlatformTimeNs();
+    for (uint32_t tick = 0; tick < opts.ticks; ++tick) {
+        if (opts.replayPath) {
+            if (!replay.next(input))
+                break;
+        } else {
+            input.yaw += 0.5f * kPlayTickDt;
+        }
+        const uint64_t startNs = PlatformTimeNs();
+        const PlayTickResult result = playTick(state, player, input, kPlayTickDt);
+        tickNs.push_back(static_cast<uint32_t>(std::min<uint64_t>(PlatformTimeNs() - startNs, UINT32_MAX)));
+        peakProjectiles = std::max(peakProjectiles, state.projectiles.count);
+        if (result == PlayTickResult::PlayerKilled)
+            break;
+        if (opts.snapshotEvery > 0 && state.ai.tick() % opts.snapshotEvery == 0 &&
+            snapshots.capture(state, player)) {
+            captureNs.push_back(static_cast<uint32_t>(snapshots.stats().lastCaptureNs));
+        }
+    }
+    const double runSeconds = (PlatformTimeNs() - runStartNs) * 1e-9;
+
+    if (tickNs.empty()) {
+        std::printf("headless: no ticks ran\n");
+        PlatformShutdown();
+        return 1;
+    }
+    std::vector<uint32_t> sorted = tickNs;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentileMs = [&](double p) {
+        return sorted[static_cast<size_t>(p * (sorted.size() - 1))] * 1e-6;
+    };
+    double totalMs = 0.0;
+    for (uint32_t ns : sorted)
+        totalMs += ns * 1e-6;
+
+    std::printf("headless: %zu ticks (%.1f s simulated) in %.3f s, %.0f ticks/s\n",
+                sorted.size(), sorted.size() / kPlayTickRate, runSeconds, sorted.size() / runSeconds);
+    std::printf("headless: tick avg %.4f ms, p50 %.4f ms, p90 %.4f ms, p99 %.4f ms, p99.9 %.4f ms, max %.4f ms\n",
+                totalMs / sorted.size(), percentileMs(0.5), percentileMs(0.9), percentileMs(0.99),
+                percentileMs(0.999), sorted.back() * 1e-6);
+    const size_t aliveEnemies = static_cast<size_t>(std::count_if(
+        state.enemies.begin(), state.enemies.end(), [](const EnemyWizard& e) { return e.alive; }));
+    std::printf("headless: end state %zu enemies, %zu projectiles (peak %zu), hash %016llx\n",
+                aliveEnemies, state.projectiles.count, peakProjectiles,
+                static_cast<unsigned long long>(hashPlayState(state, player)));
+    if (opts.replayPath && replay.ticksRead() == replay.tickCount() &&
+        opts.extraEnemies == 0 && opts.extraProjectiles == 0) {
+        std::printf("headless: replay %s\n",
+                    hashPlayState(state, player) == replay.expectedHash() ? "matches the recording" : "DIVERGED");
+    }
+    if (!captureNs.empty()) {
+        uint64_t captureSum = 0;
+        uint32_t captureMax = 0;
+        for (uint32_t ns : captureNs) {
+            captureSum += ns;
+            captureMax = std::max(captureMax, ns);
+        }
+        const SnapshotStats& snap = snapshots.stats();
+        std::printf("headless: %zu snapshots, last %zu bytes (peak %zu), capture avg %.1f us max %.1f us\n",
+                    captureNs.size(), snap.lastBytes, snap.peakBytes,
+                    captureSum * 1e-3 / captureNs.size(), captureMax * 1e-3);
+        // Rewind and play the same ticks again; without a recording the input is a function of
+        // the tick, so a complete snapshot ends on the same hash.
+        if (!opts.replayPath) {
+            const uint64_t endHash = hashPlayState(state, player);
+            const uint32_t endTick = state.ai.tick();
+            const uint32_t rewindTo = endTick > kRewindTicks ? endTick - kRewindTicks : 0;
+            if (snapshots.restore(state, player, rewindTo)) {
+                const uint32_t restoredTick = state.ai.tick();
+                input.yaw = player.yaw;
+                while (state.ai.tick() < endTick) {
+                    input.yaw += 0.5f * kPlayTickDt;
+                    if (playTick(state, player, input, kPlayTickDt) == PlayTickResult::PlayerKilled)
+                        break;
+                }
+                std::printf("headless: restore to tick %u in %.1f us, replayed %u ticks: %s\n",
+                            restoredTick, snap.lastRestoreNs * 1e-3, endTick - restoredTick,
+                            hashPlayState(state, player) == endHash ? "hash matches" : "DIVERGED");
+            }
+        }
+    }
+    if (!state.spawners.empty()) {
+        uint32_t spawned = 0;
+        for (const SpawnerState& sp : state.spawners)
+            spawned += sp.spawned;
+        std::printf("headless: %zu spawners emitted %u enemies into %zu pool slots (capacity %zu)\n",
+                    state.spawners.size(), spawned, state.enemies.size(), state.enemies.capacity());
+    }
+    const size_t peakKb = peakMemoryKb();
+    if (peakKb > 0)
+        std::printf("headless: peak memory %.1f MB\n", peakKb / 1024.0);
+
+    PlatformShutdown();
+    return 0;
+}
@@ -0,0 +1,446 @@
+// Jobs.cpp
+#include "Jobs.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#if defined(__SWITCH__)
+#include <switch.h>
+#define MAPMAKER_JOBS_LIBNX 1
+#elif defined(__EMSCRIPTEN__)
+#if defined(__EMSCRIPTEN_PTHREADS__)
+#include <emscripten/threading.h>
+#include <pthread.h>
+#include <sched.h>
+#define MAPMAKER_JOBS_PTHREADS 1
+#endif
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#define MAPMAKER_JOBS_STD 1
+#endif
+
+namespace {
+
+using ThreadEntry = void (*)(void*);
+
+#if defined(MAPMAKER_JOBS_STD)
+
+constexpr size_t kMaxWorkers = 15;
+
+size_t coreCount() {
+    return std::thread::hardware_concurrency();
+}
+
+void yieldThread() {
+    std::this_thread::yield();
+}
+
+struct WorkerThread {
+    std::thread thread;
+
+    bool start(ThreadEntry entry, void* arg, int) {
+        thread = std::thread(entry, arg);
+        return true;
+    }
+    void join() { thread.join(); }
+};
+
+struct WakeSignal {
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+    // Called with the lock held; returns with it held again.
+    void wait() {
+        std::unique_lock<std::mutex> held(mutex, std::adopt_lock);
+        cv.wait(held);
+        held.release();
+    }
+    void notifyAll() { cv.notify_all(); }
+};
+
+#elif defined(MAPMAKER_JOBS_LIBNX)
+
+// Applications get cores 0-2; core 3 belongs to the system.
+constexpr size_t kMaxWorkers = 2;
+
+size_t coreCount() {
+    return 3;
+}
+
+void yieldThread() {
+    svcSleepThread(YieldType_ToAnyThread);
+}
+
+struct WorkerThread {
+    Thread thread;
+
+    bool start(ThreadEntry entry, void* arg, int core) {
+        // Same priority as the main thread, pinned next to it.
+        if (R_FAILED(threadCreate(&thread, entry, arg, nullptr, 0x10000, 0x2C, core)))
+            return false;
+        if (R_FAILED(threadStart(&thread))) {
+            threadClose(&thread);
+            return false;
+        }
+        return true;
+    }
+    void join() {
+        threadWaitForExit(&thread);
+        threadClose(&thread);
+    }
+};
+
+struct WakeSignal {
+    Mutex mutex;
+    CondVar cv;
+
+    WakeSignal() {
+        mutexInit(&mutex);
+        condvarInit(&cv);
+    }
+    void lock() { mutexLock(&mutex); }
+    void unlock() { mutexUnlock(&mutex); }
+    void wait() { condvarWait(&cv, &mutex); }
+    void notifyAll() { condvarWakeAll(&cv); }
+};
+
+#elif defined(MAPMAKER_JOBS_PTHREADS)
+
+// Must not exceed -sPTHREAD_POOL_SIZE in the Makefile, or thread creation waits on the browser.
+constexpr size_t kMaxWorkers = 3;
+
+size_t coreCount() {
+    return static_cast<size_t>(emscripten_num_logical_cores());
+}
+
+void yieldThread() {
+    sched_yield();
+}
+
+struct WorkerThread {
+    pthread_t thread;
+    ThreadEntry entry = nullptr;
+    void* arg = nullptr;
+
+    bool start(ThreadEntry fn, void* data, int) {
+        entry = fn;
+        arg = data;
+        return pthread_create(&thread, nullptr, [](void* self) -> void* {
+            auto* t = static_cast<WorkerThread*>(self);
+            t->entry(t->arg);
+            return nullptr;
+        }, this) == 0;
+    }
+    void join() { pthread_join(thread, nullptr); }
+};
+
+struct WakeSignal {
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t cv = PTHREAD_COND_INITIALIZER;
+
+    void lock() { pthread_mutex_lock(&mutex); }
+    void unlock() { pthread_mutex_unlock(&mutex); }
+    void wait() { pthread_cond_wait(&cv, &mutex); }
+    void notifyAll() { pthread_cond_broadcast(&cv); }
+};
+
+#endif
+
+#if defined(MAPMAKER_JOBS_STD) || defined(MAPMAKER_JOBS_LIBNX) || defined(MAPMAKER_JOBS_PTHREADS)
+#define MAPMAKER_JOBS_THREADED 1
+#endif
+
+// Chase-Lev deque: the owner pushes and pops at the bottom, thieves take from the top.
+class WorkDeque {
+public:
+    static constexpr int64_t kCapacity = 1024;
+
+    bool push(const Job& job) {
+        const int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const int64_t t = m_top.load(std::memory_order_acquire);
+        if (b - t >= kCapacity)
+            return false;
+        m_jobs[b & (kCapacity - 1)] = job;
+        m_bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(Job& job) {
+        const int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        // seq_cst store/load pair: a concurrent steal either sees the lowered bottom or we see its top.
+        m_bottom.store(b, std::memory_order_seq_cst);
+        int64_t t = m_top.load(std::memory_order_seq_cst);
+        if (t > b) {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        job = m_jobs[b & (kCapacity - 1)];
+        if (t == b) {
+            // Last job: race the thieves for it.
+            const bool won = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                           std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    bool steal(Job& job) {
+        int64_t t = m_top.load(std::memory_order_seq_cst);
+        const int64_t b = m_bottom.load(std::memory_order_seq_cst);
+        if (t >= b)
+            return false;
+        job = m_jobs[t & (kCapacity - 1)];
+        return m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                             std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> m_top{0};
+    alignas(64) std::atomic<int64_t> m_bottom{0};
+    Job m_jobs[kCapacity];
+};
+
+// Slot 0 belongs to the thread that called jobsStart; workers use 1..workerCount.
+thread_local int t_slot = -1;
+
+} // namespace
+
+class JobSystem {
+public:
+    static bool start();
+    static void stop();
+    static size_t workerCount() { return s_workerCount.load(std::memory_order_relaxed); }
+    static void submit(const Job& job, JobCounter* counter);
+    static void submitAfter(JobCounter& dependency, const Job& job, JobCounter* counter);
+    static void wait(JobCounter& counter);
+
+private:
+    static void push(const Job& job);
+    static bool runOne(int slot);
+    static void run(const Job& job);
+    static void finish(JobCounter* counter);
+#ifdef MAPMAKER_JOBS_THREADED
+    static void workerMain(void* arg);
+
+    static std::unique_ptr<WorkDeque[]> s_deques;
+    static std::unique_ptr<WorkerThread[]> s_threads;
+    static WakeSignal s_wake;
+    static std::atomic<bool> s_stopping;
+    // Jobs sitting in deques; workers only sleep when it is zero.
+    static std::atomic<int> s_queued;
+    static std::atomic<int> s_sleepers;
+#endif
+    // Deques exist for every slot before any worker starts; workers only read this.
+    static int s_slotCount;
+    static std::atomic<size_t> s_workerCount;
+};
+
+int JobSystem::s_slotCount = 0;
+std::atomic<size_t> JobSystem::s_workerCount{0};
+#ifdef MAPMAKER_JOBS_THREADED
+std::unique_ptr<WorkDeque[]> JobSystem::s_deques;
+std::unique_ptr<WorkerThread[]> JobSystem::s_threads;
+WakeSignal JobSystem::s_wake;
+std::atomic<bool> JobSystem::s_stopping{false};
+std::atomic<int> JobSystem::s_queued{0};
+std::atomic<int> JobSystem::s_sleepers{0};
+#endif
+
+bool JobSystem::start() {
+#ifdef MAPMAKER_JOBS_THREADED
+    if (s_workerCount > 0)
+        return true;
+    const size_t cores = coreCount();
+    const size_t wanted = std::min(kMaxWorkers, cores > 1 ? cores - 1 : 0);
+    if (wanted == 0) {
+        std::printf("Job system: single core, jobs run inline\n");
+        return false;
+    }
+    s_deques.reset(new WorkDeque[wanted + 1]);
+    s_threads.reset(new WorkerThread[wanted]);
+    s_stopping.store(false);
+    s_slotCount = static_cast<int>(wanted) + 1;
+    t_slot = 0;
+    size_t started = 0;
+    for (; started < wanted; ++started) {
+        void* arg = reinterpret_cast<void*>(static_cast<intptr_t>(started + 1));
+        if (!s_threads[started].start(&JobSystem::workerMain, arg, static_cast<int>(started + 1)))
+            break;
+    }
+    s_workerCount = started;
+    std::printf("Job system: %zu workers\n", workerCount());
+    return s_workerCount > 0;
+#else
+    std::printf("Job system: no threads on this target, jobs run inline\n");
+    return false;
+#endif
+}
+
+void JobSystem::stop() {
+#ifdef MAPMAKER_JOBS_THREADED
+    if (s_workerCount == 0)
+        return;
+    s_stopping.store(true);
+    s_wake.lock();
+    s_wake.notifyAll();
+    s_wake.unlock();
+    for (size_t i = 0, n = workerCount(); i < n; ++i)
+        s_threads[i].join();
+    s_workerCount = 0;
+    s_slotCount = 0;
+    s_threads.reset();
+    s_deques.reset();
+    s_queued.store(0);
+    t_slot = -1;
+#endif
+}
+
+void JobSystem::submit(const Job& job, JobCounter* counter) {
+    if (counter)
+        counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+    Job queued = job;
+    queued.counter = counter;
+    push(queued);
+}
+
+void JobSystem::submitAfter(JobCounter& dependency, const Job& job, JobCounter* counter) {
+    if (counter)
+        counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+    Job deferred = job;
+    deferred.counter = counter;
+    dependency.lock();
+    if (dependency.m_pending.load(std::memory_order_acquire) > 0) {
+        dependency.m_continuations.push_back(deferred);
+        dependency.unlock();
+        return;
+    }
+    dependency.unlock();
+    push(deferred);
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    while (!counter.done()) {
+#ifdef MAPMAKER_JOBS_THREADED
+        if (!runOne(t_slot))
+            yieldThread();
+#endif
+    }
+}
+
+void JobSystem::push(const Job& job) {
+#ifdef MAPMAKER_JOBS_THREADED
+    const int slot = t_slot;
+    if (s_workerCount > 0 && slot >= 0) {
+        s_queued.fetch_add(1);
+        if (s_deques[slot].push(job)) {
+            if (s_sleepers.load() > 0) {
+                // Taking the lock orders this with a worker that is about to sleep.
+                s_wake.lock();
+                s_wake.unlock();
+                s_wake.notifyAll();
+            }
+            return;
+        }
+        s_queued.fetch_sub(1);
+    }
+#endif
+    // No workers, a foreign thread or a full deque: run it here.
+    run(job);
+}
+
+bool JobSystem::runOne(int slot) {
+#ifdef MAPMAKER_JOBS_THREADED
+    const int slots = s_slotCount;
+    if (slots == 0)
+        return false;
+    Job job;
+    bool found = slot >= 0 && s_deques[slot].pop(job);
+    for (int i = 1; !found && i <= slots; ++i) {
+        const int victim = ((slot < 0 ? 0 : slot) + i) % slots;
+        found = s_deques[victim].steal(job);
+    }
+    if (!found)
+        return false;
+    s_queued.fetch_sub(1);
+    run(job);
+    return true;
+#else
+    (void)slot;
+    return false;
+#endif
+}
+
+void JobSystem::run(const Job& job) {
+    job.fn(job.data, job.begin, job.end);
+    finish(job.counter);
+}
+
+void JobSystem::finish(JobCounter* counter) {
+    if (!counter)
+        return;
+    // The lock is held across the decrement so a waiter never frees the counter while the
+    // continuations are being taken out of it.
+    std::vector<Job> released;
+    counter->lock();
+    if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        released.swap(counter->m_continuations);
+    counter->unlock();
+    for (const Job& job : released)
+        push(job);
+}
+
+#ifdef MAPMAKER_JOBS_THREADED
+void JobSystem::workerMain(void* arg) {
+    t_slot = static_cast<int>(reinterpret_cast<intptr_t>(arg));
+    // Spin briefly before sleeping; bursts of small jobs arrive back to back.
+    constexpr int kSpinsBeforeSleep = 64;
+    int idle = 0;
+    while (!s_stopping.load(std::memory_order_acquire)) {
+        if (runOne(t_slot)) {
+            idle = 0;
+            continue;
+        }
+        if (++idle < kSpinsBeforeSleep) {
+            yieldThread();
+            continue;
+        }
+        idle = 0;
+        s_wake.lock();
+        s_sleepers.fetch_add(1);
+        while (s_queued.load() <= 0 && !s_stopping.load())
+            s_wake.wait();
+        s_sleepers.fetch_sub(1);
+        s_wake.unlock();
+    }
+}
+#endif
+
+bool jobsStart() {
+    return JobSystem::start();
+}
+
+void jobsStop() {
+    JobSystem::stop();
+}
+
+size_t jobsWorkerCount() {
+    return JobSystem::workerCount();
+}
+
+void jobsSubmit(const Job& job, JobCounter* counter) {
+    JobSystem::submit(job, counter);
+}
+
+void jobsSubmitAfter(JobCounter& dependency, const Job& job, JobCounter* counter) {
+    JobSystem::submitAfter(dependency, job, counter);
+}
+
+void jobsWait(JobCounter& counter) {
+    JobSystem::wait(counter);
+}
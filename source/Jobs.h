@@ -0,0 +1,93 @@
+// Jobs.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Work-stealing job system. Each worker owns a deque it pushes and pops at one end while
+// idle workers steal from the other. Backed by std::thread on desktop, libnx threads on
+// Switch and pthreads on an Emscripten -pthread build; elsewhere every job runs inline.
+//
+// Jobs may be submitted from the thread that called jobsStart or from inside other jobs;
+// submissions from any other thread run inline.
+
+class JobCounter;
+
+// Runs [begin, end) of whatever data points at.
+using JobFn = void (*)(void* data, size_t begin, size_t end);
+
+struct Job {
+    JobFn fn = nullptr;
+    void* data = nullptr;
+    size_t begin = 0;
+    size_t end = 0;
+    JobCounter* counter = nullptr;
+};
+
+// Counts unfinished jobs. Waiting on it helps run queued jobs instead of blocking, and
+// jobs submitted with jobsSubmitAfter are released once it reaches zero.
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool done() const {
+        return m_pending.load(std::memory_order_acquire) == 0 && !m_locked.load(std::memory_order_acquire);
+    }
+
+private:
+    friend class JobSystem;
+
+    void lock() {
+        bool expected = false;
+        while (!m_locked.compare_exchange_weak(expected, true, std::memory_order_acquire))
+            expected = false;
+    }
+    void unlock() { m_locked.store(false, std::memory_order_release); }
+
+    std::atomic<int> m_pending{0};
+    std::atomic<bool> m_locked{false};
+    std::vector<Job> m_continuations;
+};
+
+// Starts one worker per spare core; returns false when jobs will run inline.
+bool jobsStart();
+void jobsStop();
+// Worker threads, not counting the thread that called jobsStart.
+size_t jobsWorkerCount();
+
+// Queues job; counter (optional) is raised now and lowered when the job finishes.
+void jobsSubmit(const Job& job, JobCounter* counter);
+// Queues job once dependency reaches zero. counter is raised immediately.
+void jobsSubmitAfter(JobCounter& dependency, const Job& job, JobCounter* counter);
+// Runs queued jobs on this thread until counter reaches zero.
+void jobsWait(JobCounter& counter);
+
+// Calls fn(begin, end) over [0, count) in chunks of about grain items and waits for all of them.
+template <typename Fn>
+void parallelFor(size_t count, size_t grain, Fn&& fn) {
+    if (count == 0)
+        return;
+    if (grain == 0)
+        grain = 1;
+    if (count <= grain || jobsWorkerCount() == 0) {
+        fn(size_t(0), count);
+        return;
+    }
+    using Body = std::remove_reference_t<Fn>;
+    Job job;
+    job.fn = [](void* data, size_t begin, size_t end) { (*static_cast<Body*>(data))(begin, end); };
+    job.data = const_cast<void*>(static_cast<const void*>(&fn));
+    JobCounter counter;
+    // The calling thread takes the first chunk itself.
+    for (size_t begin = grain; begin < count; begin += grain) {
+        job.begin = begin;
+        job.end = begin + grain < count ? begin + grain : count;
+        jobsSubmit(job, &counter);
+    }
+    fn(size_t(0), grain);
+    jobsWait(counter);
+}
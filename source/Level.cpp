@@ -0,0 +1,186 @@
+// Level.cpp
+#include "Level.h"
+#include "EditorState.h"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+
+static uint64_t edgeKey(int a, int b) {
+    const uint32_t lo = static_cast<uint32_t>(std::min(a, b));
+    const uint32_t hi = static_cast<uint32_t>(std::max(a, b));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+void compileLevel(const EditorState& state, Level& level) {
+    level.vx.clear();
+    level.vy.clear();
+    level.edges.clear();
+    level.sectors.clear();
+    level.movers.clear();
+    level.lineTwoSided.assign(state.lines.size(), 0);
+    level.doorLines.clear();
+    level.lineDoor.assign(state.lines.size(), -1);
+    level.portalCount = 0;
+
+    for (const auto& v : state.vertices) {
+        level.vx.push_back(v.first);
+        level.vy.push_back(v.second);
+    }
+    const int vertexCount = static_cast<int>(state.vertices.size());
+
+    std::unordered_map<uint64_t, int> lineByKey;
+    for (size_t i = 0; i < state.lines.size(); ++i) {
+        const LineDef& line = state.lines[i];
+        if (line.v1 < 0 || line.v2 < 0 || line.v1 >= vertexCount || line.v2 >= vertexCount)
+            continue;
+        lineByKey.emplace(edgeKey(line.v1, line.v2), static_cast<int>(i));
+        if (line.door) {
+            level.lineDoor[i] = static_cast<int32_t>(level.doorLines.size());
+            level.doorLines.push_back(static_cast<int>(i));
+        }
+    }
+
+    // First edge seen for each vertex pair; a second sector using the same pair makes a portal.
+    std::unordered_map<uint64_t, int> edgeByKey;
+    for (size_t s = 0; s < state.sectors.size(); ++s) {
+        const Sector& sector = state.sectors[s];
+        LevelSector ls;
+        ls.firstEdge = static_cast<uint32_t>(level.edges.size());
+        ls.edgeCount = static_cast<uint32_t>(sector.vertices.size());
+        ls.minX = ls.minY = 1e30f;
+        ls.maxX = ls.maxY = -1e30f;
+        ls.floorHeight = sector.floorHeight;
+        ls.ceilingHeight = sector.ceilingHeight;
+        for (size_t i = 0; i < sector.vertices.size(); ++i) {
+            LevelEdge edge;
+            edge.sector = static_cast<int>(s);
+            const int a = sector.vertices[i];
+            const int b = sector.vertices[(i + 1) % sector.vertices.size()];
+            if (a >= 0 && b >= 0 && a < vertexCount && b < vertexCount && sector.vertices.size() >= 3) {
+                edge.v1 = a;
+                edge.v2 = b;
+                ls.minX = std::min(ls.minX, level.vx[a]);
+                ls.minY = std::min(ls.minY, level.vy[a]);
+                ls.maxX = std::max(ls.maxX, level.vx[a]);
+                ls.maxY = std::max(ls.maxY, level.vy[a]);
+
+                const uint64_t key = edgeKey(a, b);
+                auto line = lineByKey.find(key);
+                if (line != lineByKey.end())
+                    edge.line = line->second;
+                auto other = edgeByKey.find(key);
+                if (other == edgeByKey.end()) {
+                    edgeByKey.emplace(key, static_cast<int>(level.edges.size()));
+                } else {
+                    LevelEdge& twin = level.edges[other->second];
+                    if (twin.sector != edge.sector && twin.otherSector < 0) {
+                        twin.otherSector = edge.sector;
+                        edge.otherSector = twin.sector;
+                        ++level.portalCount;
+                        if (edge.line >= 0)
+                            level.lineTwoSided[edge.line] = 1;
+                    }
+                }
+            }
+            level.edges.push_back(edge);
+        }
+        level.sectors.push_back(ls);
+    }
+
+    // Doors close down onto their floor; lifts lower to the lowest floor next to them.
+    for (size_t s = 0; s < state.sectors.size(); ++s) {
+        const SectorMover kind = state.sectors[s].mover;
+        if (kind == SectorMover::None)
+            continue;
+        if (level.movers.size() == kMaxSectorMovers) {
+            std::printf("level: more than %d moving sectors, sector %zu stays put\n", kMaxSectorMovers, s);
+            continue;
+        }
+        LevelSector& ls = level.sectors[s];
+        LevelMover mover;
+        mover.sector = static_cast<int>(s);
+        mover.kind = kind;
+        if (kind == SectorMover::Door) {
+            mover.restHeight = ls.ceilingHeight;
+            mover.travel = ls.floorHeight - ls.ceilingHeight;
+        } else {
+            mover.restHeight = ls.floorHeight;
+            for (uint32_t e = ls.firstEdge; e < ls.firstEdge + ls.edgeCount; ++e) {
+                const int other = level.edges[e].otherSector;
+                if (other >= 0)
+                    mover.travel = std::min(mover.travel, level.sectors[other].floorHeight - ls.floorHeight);
+            }
+        }
+        ls.mover = static_cast<int>(level.movers.size());
+        level.movers.push_back(mover);
+    }
+
+    std::printf("level: %zu sectors, %zu edges, %zu portals, %zu movers, %zu doors\n",
+                level.sectors.size(), level.edges.size(), level.portalCount, level.movers.size(),
+                level.doorLines.size());
+    buildBsp(level, level.bsp);
+    if (level.reject.key != levelRejectKey(level) || level.reject.sectorCount != level.sectors.size())
+        buildReject(level, level.reject);
+    else
+        level.reject.buildMs = 0.0;
+}
+
+bool pointInSector(const Level& level, int sector, float x, float y) {
+    const LevelSector& ls = level.sectors[sector];
+    if (x < ls.minX || x > ls.maxX || y < ls.minY || y > ls.maxY)
+        return false;
+    bool inside = false;
+    for (uint32_t e = ls.firstEdge; e < ls.firstEdge + ls.edgeCount; ++e) {
+        const LevelEdge& edge = level.edges[e];
+        if (edge.v1 < 0)
+            continue;
+        const float ax = level.vx[edge.v1], ay = level.vy[edge.v1];
+        const float bx = level.vx[edge.v2], by = level.vy[edge.v2];
+        if ((ay > y) != (by > y)) {
+            const float ix = ax + (y - ay) * (bx - ax) / (by - ay);
+            if (x < ix)
+                inside = !inside;
+        }
+    }
+    return inside;
+}
+
+int findSectorAt(const Level& level, float x, float y) {
+    const int subsector = bspFindSubsector(level.bsp, x, y);
+    if (subsector < 0)
+        return -1;
+    // Leaves also cover the void outside the map, so confirm before trusting the answer.
+    const int sector = level.bsp.subsectors[subsector].sector;
+    if (sector >= 0 && pointInSector(level, sector, x, y))
+        return sector;
+    // Points exactly on a shared edge can land in the neighbour's leaf; only those and
+    // points outside the map pay for the linear scan.
+    for (size_t s = 0; s < level.sectors.size(); ++s) {
+        if (pointInSector(level, static_cast<int>(s), x, y))
+            return static_cast<int>(s);
+    }
+    return -1;
+}
+
+int locateSector(const Level& level, float x, float y) {
+    const int subsector = bspFindSubsector(level.bsp, x, y);
+    return subsector < 0 ? -1 : level.bsp.subsectors[subsector].sector;
+}
+
+bool canStepBetween(const Level& level, int from, int to, float moverHeight) {
+    if (from < 0 || to < 0 || from == to)
+        return true;
+    const LevelSector& a = level.sectors[from];
+    const LevelSector& b = level.sectors[to];
+    return b.floorHeight - a.floorHeight <= kMaxStepHeight &&
+           std::min(a.ceilingHeight, b.ceilingHeight) - std::max(a.floorHeight, b.floorHeight) >= moverHeight;
+}
+
+void setMoverOffset(Level& level, int mover, float offset) {
+    const LevelMover& m = level.movers[mover];
+    LevelSector& ls = level.sectors[m.sector];
+    if (m.kind == SectorMover::Door)
+        ls.ceilingHeight = m.restHeight + offset;
+    else
+        ls.floorHeight = m.restHeight + offset;
+}
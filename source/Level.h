@@ -0,0 +1,80 @@
+// Level.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Bsp.h"
+#include "Mesh3D.h"
+#include "Reject.h"
+
+struct EditorState;
+
+// Tallest floor rise a walker climbs without jumping.
+constexpr float kMaxStepHeight = 0.6f;
+
+// Sectors with a moving plane: a door's ceiling drops to its floor when closed, a lift's
+// floor lowers to its lowest neighbour. The renderer offsets their vertices in the shader.
+enum class SectorMover : uint8_t {
+    None,
+    Door,
+    Lift
+};
+
+// One side of a sector boundary. Edges shared by two sectors are portals: they get no
+// wall geometry, do not block movement and are what visibility flows through.
+struct LevelEdge {
+    int v1 = -1;
+    int v2 = -1;
+    int sector = -1;
+    int otherSector = -1; // >= 0 for portals
+    int line = -1;        // matching LineDef, or -1
+};
+
+struct LevelSector {
+    uint32_t firstEdge = 0;
+    uint32_t edgeCount = 0; // one edge per sector vertex, in sector winding order
+    float minX = 0.0f;
+    float minY = 0.0f;
+    float maxX = 0.0f;
+    float maxY = 0.0f;
+    float floorHeight = 0.0f;   // current height; moving planes are updated in place during play
+    float ceilingHeight = 3.0f;
+    int mover = -1;             // index into Level::movers
+};
+
+struct LevelMover {
+    int sector = -1;
+    SectorMover kind = SectorMover::None;
+    float restHeight = 0.0f; // the moving plane's height as drawn in the editor
+    float travel = 0.0f;     // offset from restHeight at the far end of the move, <= 0
+};
+
+// Compiled, read-only view of the editor map used by the renderer and play mode.
+struct Level {
+    std::vector<float> vx;
+    std::vector<float> vy;
+    std::vector<LevelEdge> edges;
+    std::vector<LevelSector> sectors;
+    std::vector<LevelMover> movers; // at most kMaxSectorMovers; extra ones stay put
+    std::vector<uint8_t> lineTwoSided; // indexed like EditorState::lines
+    std::vector<int> doorLines;        // LineDefs flagged as doors, in line order
+    std::vector<int32_t> lineDoor;     // per LineDef: index into doorLines, or -1
+    size_t portalCount = 0;
+    BspTree bsp;
+    RejectTable reject; // kept across compiles while the sector layout doesn't change
+};
+
+void compileLevel(const EditorState& state, Level& level);
+// Returns the sector containing (x, y), or -1 when the point is outside every sector.
+// Descends the BSP and confirms against that sector's outline, scanning only if that fails.
+int findSectorAt(const Level& level, float x, float y);
+bool pointInSector(const Level& level, int sector, float x, float y);
+// BSP descent only, O(log n), for things known to be inside the map (the player, enemies,
+// projectiles) that ask many times per tick. A point outside every sector gets a nearby one.
+int locateSector(const Level& level, float x, float y);
+// Whether a walker moverHeight tall can step from sector from into sector to: the floor rises
+// no more than kMaxStepHeight and the opening between them is tall enough. -1 (unknown) on either side allows it.
+bool canStepBetween(const Level& level, int from, int to, float moverHeight);
+// Moves mover's plane to restHeight + offset; collision reads the sector heights directly.
+void setMoverOffset(Level& level, int mover, float offset);
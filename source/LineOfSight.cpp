@@ -0,0 +1,126 @@
+// LineOfSight.cpp
+#include "LineOfSight.h"
+#include "EditorState.h"
+#include "Jobs.h"
+#include "Snapshot.h"
+#include <cmath>
+
+namespace {
+
+bool doorBlocks(const DoorState& d) {
+    return d.active && d.progress < kDoorOpenEnough;
+}
+
+// Proper crossing of segments p0-p1 and a-b; touching at an endpoint doesn't count.
+bool segmentsCross(float p0x, float p0y, float p1x, float p1y, float ax, float ay, float bx, float by) {
+    const float rx = p1x - p0x;
+    const float ry = p1y - p0y;
+    const float sx = bx - ax;
+    const float sy = by - ay;
+    const float denom = rx * sy - ry * sx;
+    if (std::fabs(denom) < 1e-12f)
+        return false;
+    const float qx = ax - p0x;
+    const float qy = ay - p0y;
+    const float t = (qx * sy - qy * sx) / denom;
+    const float u = (qx * ry - qy * rx) / denom;
+    return t > 0.0f && t < 1.0f && u > 0.0f && u < 1.0f;
+}
+
+bool rayClear(const EditorState& state, float x0, float y0, float x1, float y1) {
+    bool blocked = false;
+    state.blockmap.forEachLineOnRay(x0, y0, x1, y1, [&](int li) {
+        if (!lineBlocks(state, li, kDoorOpenEnough))
+            return false;
+        const LineDef& line = state.lines[li];
+        const auto& a = state.vertices[line.v1];
+        const auto& b = state.vertices[line.v2];
+        blocked = segmentsCross(x0, y0, x1, y1, a.first, a.second, b.first, b.second);
+        return blocked;
+    });
+    return !blocked;
+}
+
+} // namespace
+
+void LineOfSight::clear() {
+    m_queries.clear();
+    m_cast.clear();
+    m_castVisible.clear();
+    m_cache.clear();
+    m_epoch = 1;
+    m_blockingDoors = SIZE_MAX;
+    m_lastRequests = 0;
+}
+
+void LineOfSight::reserve(size_t slots) {
+    m_queries.reserve(slots);
+    m_cast.reserve(slots);
+    m_castVisible.reserve(slots);
+    m_cache.reserve(slots);
+}
+
+void LineOfSight::saveState(SnapshotWriter& out) const {
+    out.value(m_epoch);
+    out.value(static_cast<uint64_t>(m_blockingDoors));
+    out.array(m_cache.data(), m_cache.size());
+}
+
+void LineOfSight::loadState(SnapshotReader& in) {
+    uint64_t blockingDoors = 0;
+    in.value(m_epoch);
+    in.value(blockingDoors);
+    m_blockingDoors = static_cast<size_t>(blockingDoors);
+    in.array(m_cache);
+    m_queries.clear();
+}
+
+void LineOfSight::request(uint32_t slot, float x, float y) {
+    m_queries.push_back({ slot, x, y, -1 });
+}
+
+void LineOfSight::resolve(const EditorState& state, float targetX, float targetY) {
+    // Doors only ever open, so a change in how many still block means some sight line may
+    // have cleared: drop every cached answer.
+    size_t blockingDoors = 0;
+    for (const DoorState& d : state.doors)
+        blockingDoors += doorBlocks(d) ? 1 : 0;
+    if (blockingDoors != m_blockingDoors) {
+        m_blockingDoors = blockingDoors;
+        ++m_epoch;
+    }
+
+    const int32_t targetCell = state.blockmap.cellAt(targetX, targetY);
+    m_cast.clear();
+    for (Query& q : m_queries) {
+        if (q.slot >= m_cache.size())
+            m_cache.resize(q.slot + 1);
+        q.cell = state.blockmap.cellAt(q.x, q.y);
+        const Entry& entry = m_cache[q.slot];
+        if (entry.epoch == m_epoch && entry.fromCell == q.cell && entry.toCell == targetCell && q.cell >= 0 &&
+            targetCell >= 0)
+            continue;
+        m_cast.push_back(q);
+    }
+    m_lastRequests = m_queries.size();
+    m_queries.clear();
+
+    m_castVisible.resize(m_cast.size());
+    // Sector pairs the reject table rules out never get a ray.
+    const int targetSector = findSectorAt(state.level, targetX, targetY);
+    parallelFor(m_cast.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Query& q = m_cast[i];
+            const int sector = findSectorAt(state.level, q.x, q.y);
+            m_castVisible[i] = state.level.reject.canSee(sector, targetSector) &&
+                               rayClear(state, q.x, q.y, targetX, targetY) ? 1 : 0;
+        }
+    });
+    for (size_t i = 0; i < m_cast.size(); ++i) {
+        Entry& entry = m_cache[m_cast[i].slot];
+        entry.fromCell = m_cast[i].cell;
+        entry.toCell = targetCell;
+        entry.epoch = m_epoch;
+        entry.visible = m_castVisible[i] != 0;
+    }
+}
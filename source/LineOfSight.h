@@ -0,0 +1,57 @@
+// LineOfSight.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct EditorState;
+struct SnapshotReader;
+struct SnapshotWriter;
+
+// Batched sight checks from many sources to one target (enemies to the player). Callers queue
+// requests during a tick and resolve them together; pairs of sectors the level's reject table
+// rules out are answered at once and the rest are walked through the blockmap in parallel.
+// A result is reused while neither end leaves its blockmap cell and no door has opened since,
+// so a crowd standing still against a player standing still costs nothing.
+class LineOfSight {
+public:
+    void clear();
+    // Sizes the queue and cache for this many slots so play doesn't grow them.
+    void reserve(size_t slots);
+    // Queues a check from (x, y) for slot (an enemy index). One request per slot per batch.
+    void request(uint32_t slot, float x, float y);
+    // Answers every queued request against (targetX, targetY) and empties the queue.
+    void resolve(const EditorState& state, float targetX, float targetY);
+    bool visible(uint32_t slot) const { return slot < m_cache.size() && m_cache[slot].visible; }
+
+    // The reuse cache, for play snapshots: a reused answer can differ from a fresh cast, so
+    // dropping it on restore would change what happens next.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+    size_t lastRequests() const { return m_lastRequests; }
+    size_t lastCast() const { return m_cast.size(); }
+
+private:
+    struct Query {
+        uint32_t slot;
+        float x;
+        float y;
+        int32_t cell;
+    };
+    struct Entry {
+        int32_t fromCell = -1;
+        int32_t toCell = -1;
+        uint32_t epoch = 0; // 0 never matches, so fresh entries always cast
+        bool visible = false;
+    };
+
+    std::vector<Query> m_queries;
+    std::vector<Query> m_cast;
+    std::vector<uint8_t> m_castVisible;
+    std::vector<Entry> m_cache; // by slot
+    uint32_t m_epoch = 1;
+    size_t m_blockingDoors = SIZE_MAX;
+    size_t m_lastRequests = 0;
+};
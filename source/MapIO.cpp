@@ -0,0 +1,189 @@
+// MapIO.cpp
+#include "MapIO.h"
+#include "EditorState.h"
+#include <algorithm>
+
+void buildDefaultMap(EditorState& state) {
+    state.vertices.clear();
+    state.lines.clear();
+    state.entities.clear();
+    state.sectors.clear();
+
+    const std::vector<std::pair<float, float>> verts = {
+      {0.0f, 0.0f},    // 0 bottom left
+        {0.0f, 10.0f},   // 1 top left
+        {10.0f, 10.0f},  // 2 top entry start
+        {10.0f, 6.0f},   // 3 vertical hall cutout (top)
+        {12.0f, 6.0f},   // 4 vertical hall cutout (top)
+        {12.0f, 10.0f},  // 5 back to top edge
+        {22.0f, 10.0f},
+        {22.0f, 6.0f},   // 6 vertical hall cutout (top)
+        {24.0f, 6.0f},   // 7 vertical hall cutout (top)
+        {24.0f, 10.0f},  // 8 back to top edge
+        {34.0f, 10.0f},  // 10 slight rise near right end
+        {34.0f, 6.0f},
+        {36.0f, 6.0f},
+        {36.0f, 11.0f},  // 6 slight rise toward right end
+        {48.0f, 11.0f},  // 7 far top right
+        {48.0f, -1.0f},  // 8 far bottom right
+        {36.0f, -1.0f},  // 9 slight drop near right end
+        {36.0f, 4.0f},   // 10 angled return
+        {34.0f, 4.0f},   // 11 angled return
+        {34.0f, 0.0f},   // 10 angled return
+        {24.0f, 0.0f},   // 11 mid bottom
+        {24.0f, 4.0f},   // 12 bottom hall cutout top
+        {22.0f, 4.0f},   // 13 bottom hall cutout top (left)
+        {22.0f, 0.0f},   // 14 return down
+        {12.0f, 0.0f},   // 15 bottom near entry
+        {12.0f, 4.0f},   // 16 bottom hall cutout top (right)
+        {10.0f, 4.0f},   // 17 bottom hall cutout top (left)
+        {10.0f, 0.0f},   // 18 close to origin along bottom
+    };
+
+    for (const auto& v : verts) {
+        state.vertices.push_back(v);
+    }
+
+    auto addLine = [&](uint16_t a, uint16_t b) { state.lines.push_back({a, b}); };
+    for (uint16_t i = 0; i < static_cast<uint16_t>(state.vertices.size()); ++i) {
+        uint16_t next = static_cast<uint16_t>((i + 1) % state.vertices.size());
+        addLine(i, next);
+    }
+    // Entities
+    state.entities.push_back({5.0f, 5.0f, EntityType::PlayerStart});
+    state.entities.push_back({17.0f, 5.0f, EntityType::EnemyWizard});
+    state.entities.push_back({29.0f, 5.0f, EntityType::ItemPickup});
+    state.entities.push_back({39.0f, 5.0f, EntityType::EnemyWizard});
+    state.entities.push_back({43.0f, 3.0f, EntityType::EnemyWizard});
+    state.entities.push_back({43.0f, 7.0f, EntityType::EnemyWizard});
+
+    // Single sector covering the whole footprint
+    Sector s;
+    s.vertices.resize(state.vertices.size());
+    for (size_t i = 0; i < state.vertices.size(); ++i) {
+        s.vertices[i] = static_cast<int>(i);
+    }
+    float area = 0.0f;
+    for (size_t i = 0; i < s.vertices.size(); ++i) {
+        const auto& p0 = state.vertices[s.vertices[i]];
+        const auto& p1 = state.vertices[s.vertices[(i + 1) % s.vertices.size()]];
+        area += p0.first * p1.second - p1.first * p0.second;
+    }
+    s.clockwise = (area < 0.0f);
+    state.sectors.push_back(std::move(s));
+
+    // Doors across the middle of each corridor
+    for (float x : {11.0f, 23.0f, 35.0f}) {
+        const int a = static_cast<int>(state.vertices.size());
+        state.vertices.push_back({x, 4.0f});
+        state.vertices.push_back({x, 6.0f});
+        state.lines.push_back({a, a + 1, true});
+    }
+}
+
+void writeMap(const EditorState& state, ByteWriter& out) {
+    out.u32(static_cast<uint32_t>(state.vertices.size()));
+    for (const auto& v : state.vertices) {
+        out.f32(v.first);
+        out.f32(v.second);
+    }
+    out.u32(static_cast<uint32_t>(state.lines.size()));
+    for (const LineDef& line : state.lines) {
+        out.i32(line.v1);
+        out.i32(line.v2);
+        out.u8(line.door ? 1 : 0);
+    }
+    out.u32(static_cast<uint32_t>(state.sectors.size()));
+    for (const Sector& sector : state.sectors) {
+        out.u32(static_cast<uint32_t>(sector.vertices.size()));
+        for (int v : sector.vertices)
+            out.i32(v);
+        out.u8(sector.clockwise ? 1 : 0);
+        out.f32(sector.floorHeight);
+        out.f32(sector.ceilingHeight);
+        out.u8(static_cast<uint8_t>(sector.mover));
+    }
+    out.u32(static_cast<uint32_t>(state.entities.size()));
+    for (const Entity& e : state.entities) {
+        out.f32(e.x);
+        out.f32(e.y);
+        out.u8(static_cast<uint8_t>(e.type));
+        if (e.type == EntityType::Spawner) {
+            out.u16(e.waveSize);
+            out.u16(e.waveCap);
+            out.f32(e.waveInterval);
+        }
+    }
+}
+
+bool readMap(ByteReader& in, EditorState& state) {
+    state.vertices.clear();
+    state.lines.clear();
+    state.sectors.clear();
+    state.entities.clear();
+
+    // Counts are checked against the bytes left so a corrupt header can't trigger a huge allocation.
+    const uint32_t vertexCount = in.u32();
+    if (!in.need(static_cast<size_t>(vertexCount) * 8))
+        return false;
+    state.vertices.resize(vertexCount);
+    for (auto& v : state.vertices) {
+        v.first = in.f32();
+        v.second = in.f32();
+    }
+    const uint32_t lineCount = in.u32();
+    if (!in.need(static_cast<size_t>(lineCount) * 9))
+        return false;
+    state.lines.resize(lineCount);
+    for (LineDef& line : state.lines) {
+        line.v1 = in.i32();
+        line.v2 = in.i32();
+        line.door = in.u8() != 0;
+        if (line.v1 < 0 || line.v2 < 0 || line.v1 >= static_cast<int>(vertexCount) ||
+            line.v2 >= static_cast<int>(vertexCount))
+            return false;
+    }
+    const uint32_t sectorCount = in.u32();
+    if (!in.need(static_cast<size_t>(sectorCount) * 14))
+        return false;
+    state.sectors.resize(sectorCount);
+    for (Sector& sector : state.sectors) {
+        const uint32_t count = in.u32();
+        if (!in.need(static_cast<size_t>(count) * 4 + 10))
+            return false;
+        sector.vertices.resize(count);
+        for (int& v : sector.vertices) {
+            v = in.i32();
+            if (v < 0 || v >= static_cast<int>(vertexCount))
+                return false;
+        }
+        sector.clockwise = in.u8() != 0;
+        sector.floorHeight = in.f32();
+        sector.ceilingHeight = in.f32();
+        const uint8_t mover = in.u8();
+        if (mover > static_cast<uint8_t>(SectorMover::Lift))
+            return false;
+        sector.mover = static_cast<SectorMover>(mover);
+    }
+    const uint32_t entityCount = in.u32();
+    if (!in.need(static_cast<size_t>(entityCount) * 9))
+        return false;
+    state.entities.resize(entityCount);
+    for (Entity& e : state.entities) {
+        e.x = in.f32();
+        e.y = in.f32();
+        const uint8_t type = in.u8();
+        if (type > static_cast<uint8_t>(EntityType::Spawner))
+            return false;
+        e.type = static_cast<EntityType>(type);
+        if (e.type == EntityType::Spawner) {
+            e.waveSize = std::min<uint16_t>(std::max<uint16_t>(in.u16(), 1), kMaxSpawnerWave);
+            e.waveCap = std::min<uint16_t>(std::max<uint16_t>(in.u16(), e.waveSize), kMaxSpawnerCap);
+            e.waveInterval = in.f32();
+            // NaN fails every comparison, so it lands on the minimum too.
+            e.waveInterval = e.waveInterval >= kMinSpawnerInterval ? e.waveInterval : kMinSpawnerInterval;
+            e.waveInterval = std::min(e.waveInterval, kMaxSpawnerInterval);
+        }
+    }
+    return in.ok;
+}
@@ -0,0 +1,89 @@
+// MapIO.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct EditorState;
+
+// Little-endian append-only writer for the binary formats (maps, replays).
+struct ByteWriter {
+    std::vector<uint8_t>& out;
+
+    void u8(uint8_t v) { out.push_back(v); }
+    void u16(uint16_t v) {
+        out.push_back(static_cast<uint8_t>(v));
+        out.push_back(static_cast<uint8_t>(v >> 8));
+    }
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; ++i)
+            out.push_back(static_cast<uint8_t>(v >> (i * 8)));
+    }
+    void u64(uint64_t v) {
+        for (int i = 0; i < 8; ++i)
+            out.push_back(static_cast<uint8_t>(v >> (i * 8)));
+    }
+    void i32(int32_t v) { u32(static_cast<uint32_t>(v)); }
+    void f32(float v) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u32(bits);
+    }
+};
+
+// Bounds-checked reader; once a read runs past the end every later read returns 0 and ok is false.
+struct ByteReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    bool need(size_t n) {
+        if (ok && static_cast<size_t>(end - p) >= n)
+            return true;
+        ok = false;
+        return false;
+    }
+    uint8_t u8() { return need(1) ? *p++ : 0; }
+    uint16_t u16() {
+        if (!need(2))
+            return 0;
+        uint16_t v = static_cast<uint16_t>(p[0] | (p[1] << 8));
+        p += 2;
+        return v;
+    }
+    uint32_t u32() {
+        if (!need(4))
+            return 0;
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i)
+            v |= static_cast<uint32_t>(p[i]) << (i * 8);
+        p += 4;
+        return v;
+    }
+    uint64_t u64() {
+        if (!need(8))
+            return 0;
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i)
+            v |= static_cast<uint64_t>(p[i]) << (i * 8);
+        p += 8;
+        return v;
+    }
+    int32_t i32() { return static_cast<int32_t>(u32()); }
+    float f32() {
+        uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+};
+
+// The built-in test map the editor starts with.
+void buildDefaultMap(EditorState& state);
+
+// Vertices, lines, sectors and entities; everything play mode is derived from.
+void writeMap(const EditorState& state, ByteWriter& out);
+// Replaces the map in state. Returns false (state left partially filled) on truncated or bad data.
+bool readMap(ByteReader& in, EditorState& state);
@@ -1,13 +1,43 @@
 // Mesh3D.h
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
+// Moving sector planes the 3D shader can offset at once; vertex mover slot 0 never moves.
+constexpr int kMaxSectorMovers = 16;
+// Mover z clamp for vertex ends that are free to move.
+constexpr float kMoverNoClamp = 1.0e6f;
+
+// A cullable piece of the world mesh. Index ranges are relative to mesh.indices; because
+// indices are grouped by material, neighbouring chunks' ranges are contiguous and merge.
+struct MeshChunk {
+    uint32_t floorStart = 0;
+    uint32_t floorCount = 0;
+    uint32_t ceilingStart = 0;
+    uint32_t ceilingCount = 0;
+    uint32_t wallStart = 0;
+    uint32_t wallCount = 0;
+    int sector = -1;
+};
+
+// A door slab: vertices [firstVertex, firstVertex + vertexCount), built closed. Opening by p
+// raises the slab's bottom edge by p * (top - bottom) while the top stays under the ceiling,
+// and only this range is rewritten on the GPU.
+struct MeshDoor {
+    uint32_t firstVertex = 0;
+    uint32_t vertexCount = 0;
+    float bottom = 0.0f;
+    float top = 0.0f;
+};
+
 struct Mesh3D {
     std::vector<float> vertices; // x,y,z
     std::vector<float> normals;  // x,y,z
     std::vector<float> colors;   // r,g,b
     std::vector<float> uvs;      // u,v
+    std::vector<float> movers;   // slot (0 = static, else Level mover + 1), wall v per unit z, min z, max z
     std::vector<uint16_t> indices;
     size_t floorIndexStart = 0;
     size_t floorIndexCount = 0;
@@ -15,4 +45,15 @@ struct Mesh3D {
     size_t ceilingIndexCount = 0;
     size_t wallIndexStart = 0;
     size_t wallIndexCount = 0;
+    size_t doorIndexStart = 0; // door slabs are few and drawn unculled in one range
+    size_t doorIndexCount = 0;
+    std::vector<MeshDoor> doors; // indexed like Level::doorLines
+    uint32_t revision = 0; // bumped on every rebuild so GPU copies know when to refresh
+
+    std::vector<MeshChunk> chunks;
+    // Chunks of sector s are [sectorChunkStart[s], sectorChunkStart[s + 1]).
+    std::vector<uint32_t> sectorChunkStart;
+    // Chunk bounds, SoA so the culling kernel can stream them.
+    std::vector<float> chunkMinX, chunkMinY, chunkMinZ;
+    std::vector<float> chunkMaxX, chunkMaxY, chunkMaxZ;
 };
@@ -1,12 +1,18 @@
 #include "Platform.h"
+#include "Jobs.h"
 
-#if __has_include(<SDL2/SDL.h>)
+// MAPMAKER_HEADLESS builds (make headless) have no SDL; time and sleep come from the C++ library.
+#if defined(MAPMAKER_HEADLESS)
+#include <chrono>
+#include <thread>
+#elif __has_include(<SDL2/SDL.h>)
 #include <SDL2/SDL.h>
 #elif __has_include(<SDL3/SDL.h>)
 #include <SDL3/SDL.h>
 #else
 #include <SDL.h>
 #endif
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 
@@ -28,14 +34,17 @@ bool PlatformInit() {
         return false;
     }
     setvbuf(stdout, NULL, _IONBF, 0);
+    jobsStart();
     return true;
 #else
     g_running = true;
+    jobsStart();
     return true;
 #endif
 }
 
 void PlatformShutdown() {
+    jobsStop();
 #ifdef __SWITCH__
     romfsExit();
     socketExit();
@@ -43,8 +52,10 @@ void PlatformShutdown() {
 }
 
 bool PlatformRunning() {
-#ifdef __SWITCH__
+#if defined(__SWITCH__)
     return appletMainLoop();
+#elif defined(MAPMAKER_HEADLESS)
+    return g_running;
 #else
     if (!g_running)
         return false;
@@ -62,16 +73,88 @@ bool PlatformRunning() {
 }
 
 uint64_t PlatformTicks() {
-#ifdef __SWITCH__
+#if defined(__SWITCH__)
     return SDL_GetTicks();
+#elif defined(MAPMAKER_HEADLESS)
+    return PlatformTimeNs() / 1000000;
 #else
     return SDL_GetTicks64();
 #endif
 }
 
+uint64_t PlatformTimeNs() {
+#if defined(__SWITCH__)
+    return armTicksToNs(armGetSystemTick());
+#elif defined(MAPMAKER_HEADLESS)
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+    static const uint64_t freq = SDL_GetPerformanceFrequency();
+    const uint64_t counter = SDL_GetPerformanceCounter();
+    // Split so counter * 1e9 cannot overflow.
+    return (counter / freq) * 1000000000ull + (counter % freq) * 1000000000ull / freq;
+#endif
+}
+
+void PlatformSleepUntilNs(uint64_t deadlineNs) {
+    const uint64_t now = PlatformTimeNs();
+    if (now >= deadlineNs)
+        return;
+#if defined(__SWITCH__)
+    svcSleepThread(static_cast<s64>(deadlineNs - now));
+#elif defined(__EMSCRIPTEN__)
+    // The browser paces frames through requestAnimationFrame; blocking would only stall it.
+#elif defined(MAPMAKER_HEADLESS)
+    std::this_thread::sleep_for(std::chrono::nanoseconds(deadlineNs - now));
+#else
+    // OS sleeps can overshoot by a scheduler tick, so the last 2 ms are spun.
+    const uint64_t spinNs = 2000000;
+    if (deadlineNs - now > spinNs)
+        SDL_Delay(static_cast<Uint32>((deadlineNs - now - spinNs) / 1000000));
+    while (PlatformTimeNs() < deadlineNs) {}
+#endif
+}
+
+uint64_t FramePacer::beginFrame() {
+    m_slept = false;
+    if (m_periodNs > 0 && m_lastPresentNs > 0) {
+        const uint64_t leadNs = m_workEstimateNs + m_marginNs;
+        if (leadNs < m_periodNs) {
+            const uint64_t startNs = m_lastPresentNs + m_periodNs - leadNs;
+            if (startNs > PlatformTimeNs()) {
+                PlatformSleepUntilNs(startNs);
+                m_slept = true;
+            }
+        }
+    }
+    m_frameStartNs = PlatformTimeNs();
+    return m_frameStartNs;
+}
+
+void FramePacer::endWork() {
+    const uint64_t workNs = PlatformTimeNs() - m_frameStartNs;
+    // Peak-hold: a slow frame raises the estimate at once, recovery is gradual.
+    if (workNs > m_workEstimateNs)
+        m_workEstimateNs = workNs;
+    else
+        m_workEstimateNs -= (m_workEstimateNs - workNs) / 16;
+}
+
+void FramePacer::endFrame(uint64_t presentNs) {
+    // No swap since the last call (the render thread is behind): keep the old anchor.
+    if (presentNs <= m_lastPresentNs)
+        return;
+    // Sleeping and then missing a vblank costs a whole period; widen the margin when it happens.
+    if (m_slept && m_lastPresentNs > 0 && presentNs - m_lastPresentNs > m_periodNs + m_periodNs / 2)
+        m_marginNs = std::min<uint64_t>(m_marginNs + 1000000, m_periodNs / 2);
+    m_lastPresentNs = presentNs;
+}
+
 std::string PlatformDataPath() {
-#ifdef __SWITCH__
+#if defined(__SWITCH__)
     return "romfs:/data/";
+#elif defined(MAPMAKER_HEADLESS)
+    return "data/";
 #else
     const char* base = SDL_GetBasePath();
     std::string path;
@@ -118,3 +201,16 @@ bool PlatformReadFile(const char* path, std::vector<unsigned char>& outData) {
 
     return true;
 }
+
+bool PlatformWriteFile(const char* path, const std::vector<unsigned char>& data) {
+    if (!path || path[0] == '\0') {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
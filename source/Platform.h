@@ -4,9 +4,38 @@
 #include <string>
 #include <vector>
 
-bool PlatformInit();        // runs at program start
+bool PlatformInit();        // runs at program start; also starts the job system (Jobs.h)
 void PlatformShutdown();    // cleanup
 bool PlatformRunning();     // master loop condition
 uint64_t PlatformTicks();   // milliseconds
+uint64_t PlatformTimeNs();  // monotonic nanoseconds, for frame timing
+void PlatformSleepUntilNs(uint64_t deadlineNs); // coarse sleep, then spin the last stretch
 std::string PlatformDataPath(); // "romfs:/data/" or "data/"
 bool PlatformReadFile(const char* path, std::vector<unsigned char>& outData);
+bool PlatformWriteFile(const char* path, const std::vector<unsigned char>& data);
+
+// Starts each frame as late as the previous frames' work allows, so input sampled at the
+// top of the frame is as fresh as possible when the swap lands. Without vsync it also caps
+// the frame rate to the target period. A period of 0 disables sleeping.
+class FramePacer {
+public:
+    void setTargetPeriodNs(uint64_t periodNs) { m_periodNs = periodNs; }
+    uint64_t targetPeriodNs() const { return m_periodNs; }
+    // Sleeps toward the next frame start and returns the frame's start time.
+    uint64_t beginFrame();
+    // Call once the frame's CPU work is submitted, just before the swap.
+    void endWork();
+    // Call after endFrame with the time the latest swap returned (RendererGL::lastPresentNs).
+    // With a render thread that is usually the previous frame's swap, which keeps the frame
+    // starts anchored to real presents rather than to when a packet was queued.
+    void endFrame(uint64_t presentNs);
+    uint64_t workEstimateNs() const { return m_workEstimateNs; }
+
+private:
+    uint64_t m_periodNs = 0;
+    uint64_t m_frameStartNs = 0;
+    uint64_t m_lastPresentNs = 0;
+    uint64_t m_workEstimateNs = 0;
+    uint64_t m_marginNs = 2000000;
+    bool m_slept = false;
+};
@@ -0,0 +1,612 @@
+// PlaySim.cpp
+#include "PlaySim.h"
+#include "Collision.h"
+#include "EditorState.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+struct Vec2 {
+    float x;
+    float y;
+};
+
+Vec2 closestPointOnSegment(float px, float py, float ax, float ay, float bx, float by) {
+    float vx = bx - ax;
+    float vy = by - ay;
+    float wx = px - ax;
+    float wy = py - ay;
+    float len2 = vx * vx + vy * vy;
+    float t = (len2 > 0.0f) ? ((wx * vx + wy * vy) / len2) : 0.0f;
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+    return { ax + vx * t, ay + vy * t };
+}
+
+float distance2D(float x1, float y1, float x2, float y2) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Whether the move (x0, y0) -> (x1, y1) passes through a door line that isn't fully open.
+bool crossesShutDoor(EditorState& state, float x0, float y0, float x1, float y1) {
+    if (state.doors.empty())
+        return false;
+    bool crosses = false;
+    state.blockmap.forEachLine(std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1), [&](int li) {
+        if (state.level.lineDoor[li] < 0 || !lineBlocks(state, li, 1.0f))
+            return false;
+        const auto& a = state.vertices[state.lines[li].v1];
+        const auto& b = state.vertices[state.lines[li].v2];
+        // Opposite sides of the door line, and the door's ends on opposite sides of the move.
+        const float ex = b.first - a.first;
+        const float ey = b.second - a.second;
+        const float s0 = ex * (y0 - a.second) - ey * (x0 - a.first);
+        const float s1 = ex * (y1 - a.second) - ey * (x1 - a.first);
+        const float mx = x1 - x0;
+        const float my = y1 - y0;
+        const float sa = mx * (a.second - y0) - my * (a.first - x0);
+        const float sb = mx * (b.second - y0) - my * (b.first - x0);
+        crosses = (s0 < 0.0f) != (s1 < 0.0f) && (sa < 0.0f) != (sb < 0.0f);
+        return crosses;
+    });
+    return crosses;
+}
+
+// Puts an enemy from a spawner in the newest free slot, or a new one at the end while the
+// pool's reserve lasts. O(1) either way.
+void spawnEnemy(EditorState& state, int spawner, float x, float y, float cooldown) {
+    const int sector = locateSector(state.level, x, y);
+    const float floor = sector >= 0 ? state.level.sectors[sector].floorHeight : 0.0f;
+    EnemyWizard e{ x, y, floor + 1.4f, cooldown, true };
+    e.prevX = x;
+    e.prevY = y;
+    e.spawner = spawner;
+    ++state.spawners[spawner].alive;
+    if (state.freeEnemies.empty()) {
+        state.enemies.push_back(e);
+        return;
+    }
+    const uint32_t slot = state.freeEnemies.back();
+    state.freeEnemies.pop_back();
+    state.enemies[slot] = e;
+    state.ai.respawn(state, slot);
+}
+
+// The slot goes on the free list for spawners to reuse.
+void killEnemy(EditorState& state, size_t i) {
+    EnemyWizard& e = state.enemies[i];
+    e.alive = false;
+    if (e.spawner >= 0)
+        --state.spawners[e.spawner].alive;
+    state.freeEnemies.push_back(static_cast<uint32_t>(i));
+}
+
+void spawnProjectile(EditorState& state, float x, float y, float z,
+                     float vx, float vy, float vz, bool fromPlayer) {
+    state.projectiles.spawn(x, y, z, vx, vy, vz, fromPlayer);
+}
+
+// 64-bit FNV-1a over raw bytes; floats hash by bit pattern so any drift shows.
+struct StateHasher {
+    uint64_t h = 1469598103934665603ull;
+
+    void bytes(const void* data, size_t size) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    }
+    template <typename T>
+    void value(const T& v) { bytes(&v, sizeof(v)); }
+};
+
+} // namespace
+
+void playBegin(EditorState& state, Camera3D& player) {
+    player = Camera3D{};
+    // Every moving plane starts at rest so the flow field below is baked with doors open.
+    for (size_t m = 0; m < state.level.movers.size(); ++m)
+        setMoverOffset(state.level, static_cast<int>(m), 0.0f);
+    bool foundStart = false;
+    for (const auto& e : state.entities) {
+        if (e.type == EntityType::PlayerStart) {
+            player.x = e.x;
+            player.y = e.y;
+            player.z = 1.7f;
+            foundStart = true;
+            break;
+        }
+    }
+    if (!foundStart) {
+        player.x = 4.0f;
+        player.y = 3.0f;
+        player.z = 1.7f;
+    }
+    const int startSector = locateSector(state.level, player.x, player.y);
+    if (startSector >= 0)
+        player.z = state.level.sectors[startSector].floorHeight + player.height;
+    state.enemies.clear();
+    state.ai.clear();
+    state.sight.clear();
+    state.enemyHash.clear();
+    for (const auto& e : state.entities) {
+        if (e.type == EntityType::EnemyWizard) {
+            const int sector = locateSector(state.level, e.x, e.y);
+            const float floor = sector >= 0 ? state.level.sectors[sector].floorHeight : 0.0f;
+            state.enemies.push_back({ e.x, e.y, floor + 1.4f, 0.0f, true });
+        }
+    }
+    // Spawners draw on one pool sized for every placed enemy plus every spawner's cap, with the
+    // AI, sight and hash arrays sized to match, so waves never allocate.
+    state.spawners.clear();
+    size_t poolSize = state.enemies.size();
+    for (const auto& e : state.entities) {
+        if (e.type != EntityType::Spawner)
+            continue;
+        SpawnerState sp;
+        sp.x = e.x;
+        sp.y = e.y;
+        sp.interval = std::clamp(e.waveInterval, kMinSpawnerInterval, kMaxSpawnerInterval);
+        sp.waveSize = e.waveSize;
+        sp.cap = e.waveCap;
+        state.spawners.push_back(sp);
+        poolSize += e.waveCap;
+    }
+    state.enemies.reserve(poolSize);
+    state.freeEnemies.clear();
+    state.freeEnemies.reserve(poolSize);
+    state.ai.reserve(poolSize);
+    state.sight.reserve(poolSize);
+    state.enemyHash.reserve(poolSize);
+    state.items.clear();
+    for (const auto& e : state.entities) {
+        if (e.type == EntityType::ItemPickup) {
+            const int sector = locateSector(state.level, e.x, e.y);
+            const float floor = sector >= 0 ? state.level.sectors[sector].floorHeight : 0.0f;
+            state.items.push_back({ e.x, e.y, floor + 1.0f, e.type, true });
+        }
+    }
+    state.doors.clear();
+    for (int line : state.level.doorLines) {
+        DoorState d;
+        d.line = line;
+        state.doors.push_back(d);
+    }
+    state.activeDoors.clear();
+    state.triggers.clear();
+    for (size_t i = 0; i < state.doors.size(); ++i) {
+        const LineDef& line = state.lines[state.doors[i].line];
+        const auto& a = state.vertices[line.v1];
+        const auto& b = state.vertices[line.v2];
+        state.triggers.add(TriggerKind::Door, static_cast<int>(i), 0.5f * (a.first + b.first),
+                           0.5f * (a.second + b.second), 2.0f);
+    }
+    for (size_t i = 0; i < state.items.size(); ++i)
+        state.triggers.add(TriggerKind::Item, static_cast<int>(i), state.items[i].x, state.items[i].y, 0.6f);
+    // Moving sectors react to the player anywhere in or just around them.
+    for (size_t m = 0; m < state.level.movers.size(); ++m) {
+        const LevelSector& ls = state.level.sectors[state.level.movers[m].sector];
+        const float halfW = 0.5f * (ls.maxX - ls.minX);
+        const float halfH = 0.5f * (ls.maxY - ls.minY);
+        state.triggers.add(TriggerKind::Mover, static_cast<int>(m), ls.minX + halfW, ls.minY + halfH,
+                           std::sqrt(halfW * halfW + halfH * halfH) + 1.0f);
+    }
+    state.triggers.build();
+    state.blockmap.build(state);
+    state.flow.build(state);
+    state.movers.assign(state.level.movers.size(), SectorMoverState{});
+    for (size_t m = 0; m < state.movers.size(); ++m) {
+        const LevelMover& lm = state.level.movers[m];
+        if (lm.kind != SectorMover::Door)
+            continue;
+        SectorMoverState& ms = state.movers[m];
+        ms.offset = ms.target = ms.prevOffset = lm.travel;
+        setMoverOffset(state.level, static_cast<int>(m), ms.offset);
+    }
+    state.projectiles.clear();
+    state.blocking = false;
+    state.blockFlashTimer = 0.0f;
+}
+
+PlayTickResult playTick(EditorState& state, Camera3D& player, const PlayInput& input, float dt) {
+    state.projectiles.saveHistory();
+    // Only moving doors change; one that finished last tick drops out once its history catches up.
+    for (size_t k = 0; k < state.activeDoors.size();) {
+        DoorState& d = state.doors[state.activeDoors[k]];
+        d.prevProgress = d.progress;
+        if (d.progress >= 1.0f) {
+            state.activeDoors[k] = state.activeDoors.back();
+            state.activeDoors.pop_back();
+        } else {
+            ++k;
+        }
+    }
+    for (SectorMoverState& ms : state.movers)
+        ms.prevOffset = ms.offset;
+    for (auto& e : state.enemies) {
+        e.prevX = e.x;
+        e.prevY = e.y;
+    }
+    state.flow.sync();
+
+    // Each wave tops a spawner back up towards its cap, spread on a golden-angle spiral so the
+    // wave doesn't stack on one point; spots inside walls fall back to the spawner itself.
+    for (size_t s = 0; s < state.spawners.size(); ++s) {
+        SpawnerState& sp = state.spawners[s];
+        sp.timer -= dt;
+        if (sp.timer > 0.0f)
+            continue;
+        sp.timer += sp.interval;
+        const uint32_t room = sp.cap > sp.alive ? sp.cap - sp.alive : 0;
+        const uint32_t wave = std::min<uint32_t>(sp.waveSize, room);
+        for (uint32_t k = 0; k < wave; ++k) {
+            const uint32_t n = sp.spawned++;
+            const float angle = static_cast<float>(n) * 2.3999632f;
+            const float radius = 0.5f + 0.2f * static_cast<float>(n % 8);
+            float x = sp.x + std::cos(angle) * radius;
+            float y = sp.y + std::sin(angle) * radius;
+            if (!state.flow.walkable(x, y) || locateSector(state.level, x, y) < 0) {
+                x = sp.x;
+                y = sp.y;
+            }
+            // Staggered first shots so a wave doesn't fire as one volley.
+            spawnEnemy(state, static_cast<int>(s), x, y, 1.0f + 0.25f * static_cast<float>(n % 4));
+        }
+    }
+
+    player.yaw = input.yaw;
+    player.pitch = std::clamp(input.pitch, -1.2f, 1.2f);
+    state.blocking = input.block;
+
+    const float moveSpeed = 5.0f;
+
+    const float forwardX = std::sin(player.yaw);
+    const float forwardY = std::cos(player.yaw);
+    const float rightX = std::cos(player.yaw);
+    const float rightY = -std::sin(player.yaw);
+
+    float moveForward = -input.moveY;
+    float moveStrafe = input.moveX;
+
+    float newX = player.x;
+    float newY = player.y;
+    if (!state.blocking) {
+        newX += (forwardX * moveForward + rightX * moveStrafe) * moveSpeed * dt;
+        newY += (forwardY * moveForward + rightY * moveStrafe) * moveSpeed * dt;
+    }
+
+    // Doors open and items are picked up when the player walks into their trigger. Sector doors
+    // stay open while the player is near; lifts go down when at rest and come back on their own.
+    for (const TriggerEvent& ev : state.triggers.update(player.x, player.y)) {
+        if (ev.kind == TriggerKind::Mover) {
+            const LevelMover& lm = state.level.movers[ev.target];
+            SectorMoverState& ms = state.movers[ev.target];
+            if (lm.kind == SectorMover::Door)
+                ms.target = ev.entered ? 0.0f : lm.travel;
+            else if (ev.entered && ms.offset == 0.0f && ms.target == 0.0f)
+                ms.target = lm.travel;
+            continue;
+        }
+        if (!ev.entered) continue;
+        if (ev.kind == TriggerKind::Door) {
+            DoorState& d = state.doors[ev.target];
+            if (d.locked || d.opening) continue;
+            d.opening = true;
+            state.activeDoors.push_back(ev.target);
+            state.triggers.setEnabled(ev.trigger, false);
+        } else if (ev.kind == TriggerKind::Item) {
+            ItemWorld& it = state.items[ev.target];
+            if (!it.alive) continue;
+            it.alive = false;
+            state.triggers.setEnabled(ev.trigger, false);
+            std::printf("Picked up item!\n");
+        }
+    }
+    for (int di : state.activeDoors) {
+        DoorState& d = state.doors[di];
+        d.progress = std::min(d.progress + dt * 1.5f, 1.0f);
+    }
+    // Moving planes travel at a fixed speed; a lift waits at the bottom before rising again.
+    const float moverSpeed = 2.0f;
+    const float liftWait = 2.0f;
+    for (size_t m = 0; m < state.movers.size(); ++m) {
+        SectorMoverState& ms = state.movers[m];
+        if (ms.offset == ms.target) {
+            if (state.level.movers[m].kind == SectorMover::Lift && ms.target < 0.0f) {
+                ms.wait -= dt;
+                if (ms.wait <= 0.0f)
+                    ms.target = 0.0f;
+            }
+            continue;
+        }
+        const float step = moverSpeed * dt;
+        ms.offset = ms.offset < ms.target ? std::min(ms.offset + step, ms.target)
+                                          : std::max(ms.offset - step, ms.target);
+        if (ms.offset == ms.target)
+            ms.wait = liftWait;
+        setMoverOffset(state.level, static_cast<int>(m), ms.offset);
+    }
+
+    if (input.fire) {
+        const float projSpeed = 6.0f;
+        spawnProjectile(state, player.x, player.y, player.z,
+                        forwardX * projSpeed, forwardY * projSpeed, 0.0f, true);
+    }
+
+    const float radius = player.radius;
+    // Only lines in the cells swept by the move can touch the player; doors block until fully open.
+    const float sweepMinX = std::min(player.x, newX) - radius;
+    const float sweepMinY = std::min(player.y, newY) - radius;
+    const float sweepMaxX = std::max(player.x, newX) + radius;
+    const float sweepMaxY = std::max(player.y, newY) + radius;
+    state.blockmap.forEachLine(sweepMinX, sweepMinY, sweepMaxX, sweepMaxY, [&](int li) {
+        if (!lineBlocks(state, li, 1.0f))
+            return false;
+        const LineDef& line = state.lines[li];
+        const auto& a = state.vertices[line.v1];
+        const auto& b = state.vertices[line.v2];
+        Vec2 nearest = closestPointOnSegment(newX, newY, a.first, a.second, b.first, b.second);
+        float dist = distance2D(newX, newY, nearest.x, nearest.y);
+        if (dist < radius && dist > 0.0001f) {
+            float dx = newX - nearest.x;
+            float dy = newY - nearest.y;
+            float len = std::sqrt(dx * dx + dy * dy);
+            dx /= len;
+            dy /= len;
+            newX = nearest.x + dx * radius;
+            newY = nearest.y + dy * radius;
+        }
+        return false;
+    });
+
+    // Steps are climbed; higher ledges and openings too low to fit through stop the move along
+    // whichever axis crosses them, so the player slides along the edge.
+    const Level& level = state.level;
+    const int fromSector = locateSector(level, player.x, player.y);
+    if (!canStepBetween(level, fromSector, locateSector(level, newX, newY), player.height)) {
+        if (canStepBetween(level, fromSector, locateSector(level, newX, player.y), player.height))
+            newY = player.y;
+        else if (canStepBetween(level, fromSector, locateSector(level, player.x, newY), player.height))
+            newX = player.x;
+        else
+            newX = player.x, newY = player.y;
+    }
+    player.x = newX;
+    player.y = newY;
+    const int playerSector = locateSector(level, player.x, player.y);
+    if (playerSector >= 0) {
+        const LevelSector& ls = level.sectors[playerSector];
+        player.z = std::min(ls.floorHeight + player.height, ls.ceilingHeight - 0.1f);
+    }
+
+    // Enemies close in along the shared flow field, hold position once in range and keep
+    // apart from each other. Neighbours come from last tick's hash, i.e. where they all started
+    // this tick, so the result doesn't depend on update order.
+    const float enemySpeed = 1.5f;
+    const float enemyStopDistance = 3.0f;
+    const float enemySpacing = 0.6f;
+    const float enemyHeight = FlowField::kMoverHeight;
+    for (size_t i = 0; i < state.enemies.size(); ++i) {
+        EnemyWizard& e = state.enemies[i];
+        if (!e.alive) continue;
+        const int enemySector = locateSector(level, e.x, e.y);
+        if (enemySector >= 0)
+            e.z = level.sectors[enemySector].floorHeight + 1.4f;
+        float moveX = 0.0f;
+        float moveY = 0.0f;
+        float dx, dy;
+        if (distance2D(e.x, e.y, player.x, player.y) > enemyStopDistance && state.flow.direction(e.x, e.y, dx, dy)) {
+            moveX = dx * enemySpeed;
+            moveY = dy * enemySpeed;
+        }
+        state.enemyHash.forEachInBox(e.x - enemySpacing, e.y - enemySpacing, e.x + enemySpacing, e.y + enemySpacing,
+                                     [&](uint32_t other, float ox, float oy) {
+            if (other == i || !state.enemies[other].alive) return false;
+            const float awayX = e.x - ox;
+            const float awayY = e.y - oy;
+            const float d2 = awayX * awayX + awayY * awayY;
+            if (d2 < enemySpacing * enemySpacing && d2 > 1e-8f) {
+                // Full walking speed when touching, fading to nothing at the spacing distance.
+                const float d = std::sqrt(d2);
+                const float push = enemySpeed * (enemySpacing - d) / (enemySpacing * d);
+                moveX += awayX * push;
+                moveY += awayY * push;
+            }
+            return false;
+        });
+        const float speed = std::sqrt(moveX * moveX + moveY * moveY);
+        if (speed < 1e-6f) continue;
+        if (speed > 2.0f * enemySpeed) {
+            moveX *= 2.0f * enemySpeed / speed;
+            moveY *= 2.0f * enemySpeed / speed;
+        }
+        const float nextX = e.x + moveX * dt;
+        const float nextY = e.y + moveY * dt;
+        // Crowding never shoves anyone into a wall; enemies already too close to one can leave.
+        // The flow field routes through doors, so enemies wait at shut ones.
+        if ((state.flow.walkable(nextX, nextY) || !state.flow.walkable(e.x, e.y)) &&
+            canStepBetween(level, enemySector, locateSector(level, nextX, nextY), enemyHeight) &&
+            !crossesShutDoor(state, e.x, e.y, nextX, nextY)) {
+            e.x = nextX;
+            e.y = nextY;
+        }
+    }
+    state.flow.retarget(player.x, player.y);
+
+    // Enemy AI, within a fixed per-tick budget
+    state.ai.update(state, player);
+    state.enemyHash.build(state.enemies);
+
+    // Projectiles
+    const float projectileRadius = 0.12f;
+    const float enemyRadius = 0.25f;
+    // Each step is resolved in time-of-impact order: move to the earliest contact,
+    // react, then spend what is left of the step with the new velocity.
+    const int maxProjectileEvents = 4;
+    enum class ProjectileHit { None, Wall, Door, Player, Enemy };
+    bool playerKilled = false;
+    ProjectileSystem& pool = state.projectiles;
+    projectilesIntegrateZ(pool, dt);
+    // Most shots are nowhere near the player; one SIMD pass rules them out up front.
+    projectilesNearCircle(pool, player.x, player.y, player.radius + projectileRadius, dt,
+                          pool.nearPlayer.data());
+    for (size_t i = 0; i < pool.count; ++i) {
+        float& px = pool.x[i];
+        float& py = pool.y[i];
+        float& pvx = pool.vx[i];
+        float& pvy = pool.vy[i];
+        float& pvz = pool.vz[i];
+        float remaining = 1.0f; // fraction of dt still to simulate
+        for (int event = 0; event < maxProjectileEvents && remaining > 0.0f && pool.alive(i); ++event) {
+            const float moveX = pvx * dt * remaining;
+            const float moveY = pvy * dt * remaining;
+            const float sweepMinX = std::min(px, px + moveX) - projectileRadius;
+            const float sweepMinY = std::min(py, py + moveY) - projectileRadius;
+            const float sweepMaxX = std::max(px, px + moveX) + projectileRadius;
+            const float sweepMaxY = std::max(py, py + moveY) + projectileRadius;
+
+            SweepHit hit;
+            ProjectileHit kind = ProjectileHit::None;
+            int hitEnemy = -1;
+            // Doors stop shots until nearly open.
+            state.blockmap.forEachLine(sweepMinX, sweepMinY, sweepMaxX, sweepMaxY, [&](int li) {
+                if (!lineBlocks(state, li, kDoorOpenEnough))
+                    return false;
+                const LineDef& line = state.lines[li];
+                const auto& a = state.vertices[line.v1];
+                const auto& b = state.vertices[line.v2];
+                if (sweepCircleSegment(px, py, moveX, moveY, projectileRadius,
+                                       a.first, a.second, b.first, b.second, hit))
+                    kind = level.lineDoor[li] >= 0 ? ProjectileHit::Door : ProjectileHit::Wall;
+                return false;
+            });
+            if (pool.nearPlayer[i] &&
+                sweepCircleCircle(px, py, moveX, moveY, projectileRadius,
+                                  player.x, player.y, player.radius, hit))
+                kind = ProjectileHit::Player;
+            if (pool.fromPlayer(i)) {
+                state.enemyHash.forEachInBox(sweepMinX - enemyRadius, sweepMinY - enemyRadius,
+                                             sweepMaxX + enemyRadius, sweepMaxY + enemyRadius,
+                                             [&](uint32_t ei, float, float) {
+                    EnemyWizard& e = state.enemies[ei];
+                    if (e.alive && sweepCircleCircle(px, py, moveX, moveY, projectileRadius, e.x, e.y, enemyRadius, hit)) {
+                        kind = ProjectileHit::Enemy;
+                        hitEnemy = static_cast<int>(ei);
+                    }
+                    return false;
+                });
+            }
+
+            px += moveX * hit.t;
+            py += moveY * hit.t;
+            remaining *= 1.0f - hit.t;
+
+            switch (kind) {
+                case ProjectileHit::None:
+                    remaining = 0.0f;
+                    break;
+                case ProjectileHit::Wall:
+                    if (pool.fromPlayer(i) || state.blocking) {
+                        pool.flags[i] |= ProjectileFromPlayer;
+                        float dot = pvx * hit.nx + pvy * hit.ny;
+                        pvx = pvx - 2.0f * dot * hit.nx;
+                        pvy = pvy - 2.0f * dot * hit.ny;
+                    } else {
+                        pool.kill(i);
+                    }
+                    break;
+                case ProjectileHit::Door:
+                    pool.kill(i);
+                    break;
+                case ProjectileHit::Player:
+                    if (state.blocking) {
+                        pool.flags[i] |= ProjectileFromPlayer;
+                        float dot = pvx * hit.nx + pvy * hit.ny;
+                        pvx = (pvx - 2.0f * dot * hit.nx) * 1.2f;
+                        pvy = (pvy - 2.0f * dot * hit.ny) * 1.2f;
+                        pvz = -pvz * 1.2f;
+                        state.blockFlashTimer = 0.25f;
+                    } else {
+                        playerKilled = true;
+                        remaining = 0.0f;
+                    }
+                    break;
+                case ProjectileHit::Enemy:
+                    killEnemy(state, static_cast<size_t>(hitEnemy));
+                    pool.kill(i);
+                    break;
+            }
+        }
+        // Shots that sink into a raised floor or hit a lowered ceiling stop there.
+        if (pool.alive(i)) {
+            const int sector = locateSector(level, px, py);
+            if (sector >= 0 && (pool.z[i] <= level.sectors[sector].floorHeight ||
+                                pool.z[i] >= level.sectors[sector].ceilingHeight))
+                pool.kill(i);
+        }
+        if (playerKilled) {
+            std::printf("Player hit!\n");
+            return PlayTickResult::PlayerKilled;
+        }
+    }
+
+    state.projectiles.compact();
+    if (state.blockFlashTimer > 0.0f) {
+        state.blockFlashTimer -= dt;
+        if (state.blockFlashTimer < 0.0f) state.blockFlashTimer = 0.0f;
+    }
+
+    return PlayTickResult::Running;
+}
+
+uint64_t hashPlayState(const EditorState& state, const Camera3D& player) {
+    StateHasher hash;
+    hash.value(player.x);
+    hash.value(player.y);
+    hash.value(player.z);
+    hash.value(player.yaw);
+    hash.value(player.pitch);
+    hash.value(state.blocking);
+    hash.value(state.blockFlashTimer);
+    hash.value(static_cast<uint64_t>(state.enemies.size()));
+    for (const EnemyWizard& e : state.enemies) {
+        hash.value(e.x);
+        hash.value(e.y);
+        hash.value(e.z);
+        hash.value(e.cooldown);
+        hash.value(e.alive);
+    }
+    const ProjectileSystem& pool = state.projectiles;
+    hash.value(static_cast<uint64_t>(pool.count));
+    hash.bytes(pool.x.data(), pool.count * sizeof(float));
+    hash.bytes(pool.y.data(), pool.count * sizeof(float));
+    hash.bytes(pool.z.data(), pool.count * sizeof(float));
+    hash.bytes(pool.vx.data(), pool.count * sizeof(float));
+    hash.bytes(pool.vy.data(), pool.count * sizeof(float));
+    hash.bytes(pool.vz.data(), pool.count * sizeof(float));
+    hash.bytes(pool.flags.data(), pool.count);
+    for (const DoorState& d : state.doors) {
+        hash.value(d.progress);
+        hash.value(d.opening);
+        hash.value(d.locked);
+        hash.value(d.active);
+    }
+    for (const ItemWorld& it : state.items)
+        hash.value(it.alive);
+    for (const SpawnerState& sp : state.spawners) {
+        hash.value(sp.timer);
+        hash.value(sp.alive);
+        hash.value(sp.spawned);
+    }
+    for (const SectorMoverState& ms : state.movers) {
+        hash.value(ms.offset);
+        hash.value(ms.target);
+    }
+    return hash.h;
+}
@@ -0,0 +1,40 @@
+// PlaySim.h
+#pragma once
+
+#include <cstdint>
+
+struct EditorState;
+struct Camera3D;
+
+// Play mode advances in fixed ticks; rendering interpolates between the last two.
+constexpr float kPlayTickRate = 120.0f;
+constexpr float kPlayTickDt = 1.0f / kPlayTickRate;
+// Ticks allowed per frame before the backlog is dropped, so a long stall can't snowball.
+constexpr int kPlayMaxCatchUpTicks = 8;
+
+// One tick of player input. Look angles are absolute rather than deltas so a recorded
+// stream replays to the same state.
+struct PlayInput {
+    float moveX = 0.0f; // strafe, -1 left .. 1 right
+    float moveY = 0.0f; // -1 forward .. 1 back, stick convention
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    bool block = false;
+    bool fire = false;
+};
+
+enum class PlayTickResult {
+    Running,
+    PlayerKilled,
+};
+
+// Places the player on the PlayerStart and rebuilds the session state (enemies, items, doors,
+// projectiles, blockmap) from the map's entities. The level must already be compiled.
+void playBegin(EditorState& state, Camera3D& player);
+
+// Advances the player, doors, enemies, projectiles and pickups by dt. Positions from before
+// the tick are kept (camera excepted, which the caller owns) for render interpolation.
+PlayTickResult playTick(EditorState& state, Camera3D& player, const PlayInput& input, float dt);
+
+// FNV-1a over everything a tick can change; equal hashes mean a replay stayed in sync.
+uint64_t hashPlayState(const EditorState& state, const Camera3D& player);
@@ -0,0 +1,196 @@
+// Portals.cpp
+#include "Portals.h"
+#include "Culling.h"
+#include "Level.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr int kMaxPlanes = 16;
+constexpr int kMaxPolyVerts = kMaxPlanes + 4;
+constexpr int kMaxDepth = 64;
+// Cap on portal traversals per frame; grids of tiny sectors can otherwise explode.
+constexpr int kMaxPortalVisits = 4096;
+
+struct ClipVolume {
+    float planes[kMaxPlanes][4];
+    int count = 0;
+};
+
+struct Poly {
+    float v[kMaxPolyVerts][3];
+    int count = 0;
+};
+
+struct PortalWalk {
+    const Level* level = nullptr;
+    float eye[3] = {0.0f, 0.0f, 0.0f};
+    std::vector<uint8_t>* visible = nullptr;
+    std::vector<uint8_t> onPath;
+    int start = -1;
+    int visits = 0;
+    bool overflow = false;
+};
+
+float planeDistance(const float plane[4], const float p[3]) {
+    return plane[0] * p[0] + plane[1] * p[1] + plane[2] * p[2] + plane[3];
+}
+
+// Sutherland-Hodgman against one plane, keeping the side where the distance is >= 0.
+void clipPoly(const Poly& in, const float plane[4], Poly& out) {
+    out.count = 0;
+    for (int i = 0; i < in.count; ++i) {
+        const float* a = in.v[i];
+        const float* b = in.v[(i + 1) % in.count];
+        const float da = planeDistance(plane, a);
+        const float db = planeDistance(plane, b);
+        if (da >= 0.0f && out.count < kMaxPolyVerts) {
+            std::memcpy(out.v[out.count++], a, sizeof(float) * 3);
+        }
+        if ((da >= 0.0f) != (db >= 0.0f) && out.count < kMaxPolyVerts) {
+            const float t = da / (da - db);
+            float* o = out.v[out.count++];
+            for (int c = 0; c < 3; ++c)
+                o[c] = a[c] + (b[c] - a[c]) * t;
+        }
+    }
+}
+
+void walkSector(PortalWalk& walk, int sector, const ClipVolume& volume, int depth) {
+    const Level& level = *walk.level;
+    (*walk.visible)[sector] = 1;
+    if (depth >= kMaxDepth)
+        return;
+    walk.onPath[sector] = 1;
+
+    const LevelSector& ls = level.sectors[sector];
+    for (uint32_t e = ls.firstEdge; e < ls.firstEdge + ls.edgeCount; ++e) {
+        const LevelEdge& edge = level.edges[e];
+        if (edge.otherSector < 0 || walk.onPath[edge.otherSector])
+            continue;
+        if (!level.reject.canSee(walk.start, edge.otherSector))
+            continue;
+        if (++walk.visits > kMaxPortalVisits) {
+            walk.overflow = true;
+            break;
+        }
+
+        const float ax = level.vx[edge.v1], ay = level.vy[edge.v1];
+        const float bx = level.vx[edge.v2], by = level.vy[edge.v2];
+        const LevelSector& other = level.sectors[edge.otherSector];
+        const float bottom = std::fmin(ls.floorHeight, other.floorHeight);
+        const float top = std::fmax(ls.ceilingHeight, other.ceilingHeight);
+
+        // Vertical plane through the portal, facing away from the eye.
+        float portalPlane[4] = { by - ay, ax - bx, 0.0f, 0.0f };
+        const float len = std::sqrt(portalPlane[0] * portalPlane[0] + portalPlane[1] * portalPlane[1]);
+        if (len < 1e-6f)
+            continue;
+        portalPlane[0] /= len;
+        portalPlane[1] /= len;
+        portalPlane[3] = -(portalPlane[0] * ax + portalPlane[1] * ay);
+        float eyeDist = planeDistance(portalPlane, walk.eye);
+        if (eyeDist > 0.0f) {
+            for (float& c : portalPlane)
+                c = -c;
+            eyeDist = -eyeDist;
+        }
+
+        // Standing in the doorway: the portal is degenerate, so look through it unclipped.
+        if (eyeDist > -0.05f) {
+            walkSector(walk, edge.otherSector, volume, depth + 1);
+            continue;
+        }
+
+        Poly poly;
+        poly.count = 4;
+        const float quad[4][3] = { {ax, ay, bottom}, {bx, by, bottom}, {bx, by, top}, {ax, ay, top} };
+        std::memcpy(poly.v, quad, sizeof(quad));
+        Poly scratch;
+        for (int p = 0; p < volume.count && poly.count >= 3; ++p) {
+            clipPoly(poly, volume.planes[p], scratch);
+            poly = scratch;
+        }
+        if (poly.count < 3)
+            continue;
+
+        float centroid[3] = {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < poly.count; ++i) {
+            for (int c = 0; c < 3; ++c)
+                centroid[c] += poly.v[i][c];
+        }
+        for (float& c : centroid)
+            c /= static_cast<float>(poly.count);
+
+        // The new volume is the pyramid from the eye through the clipped portal, capped by the portal plane.
+        ClipVolume next;
+        std::memcpy(next.planes[next.count++], portalPlane, sizeof(portalPlane));
+        for (int i = 0; i < poly.count && next.count < kMaxPlanes; ++i) {
+            const float* p0 = poly.v[i];
+            const float* p1 = poly.v[(i + 1) % poly.count];
+            const float u[3] = { p0[0] - walk.eye[0], p0[1] - walk.eye[1], p0[2] - walk.eye[2] };
+            const float w[3] = { p1[0] - walk.eye[0], p1[1] - walk.eye[1], p1[2] - walk.eye[2] };
+            float* plane = next.planes[next.count];
+            plane[0] = u[1] * w[2] - u[2] * w[1];
+            plane[1] = u[2] * w[0] - u[0] * w[2];
+            plane[2] = u[0] * w[1] - u[1] * w[0];
+            const float nlen = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            if (nlen < 1e-6f)
+                continue;
+            plane[0] /= nlen;
+            plane[1] /= nlen;
+            plane[2] /= nlen;
+            plane[3] = -(plane[0] * walk.eye[0] + plane[1] * walk.eye[1] + plane[2] * walk.eye[2]);
+            if (planeDistance(plane, centroid) < 0.0f) {
+                for (int c = 0; c < 4; ++c)
+                    plane[c] = -plane[c];
+            }
+            ++next.count;
+        }
+        walkSector(walk, edge.otherSector, next, depth + 1);
+        if (walk.overflow)
+            break;
+    }
+
+    walk.onPath[sector] = 0;
+}
+
+} // namespace
+
+size_t computeVisibleSectors(const Level& level, const float eye[3], const float viewProj[16],
+                             std::vector<uint8_t>& visible) {
+    visible.assign(level.sectors.size(), 0);
+    const int start = findSectorAt(level, eye[0], eye[1]);
+    if (start < 0)
+        return 0;
+
+    Frustum frustum;
+    buildFrustum(viewProj, frustum);
+    ClipVolume volume;
+    for (int p = 0; p < 6; ++p)
+        std::memcpy(volume.planes[volume.count++], frustum.planes[p], sizeof(float) * 4);
+
+    PortalWalk walk;
+    walk.level = &level;
+    std::memcpy(walk.eye, eye, sizeof(walk.eye));
+    walk.visible = &visible;
+    walk.onPath.assign(level.sectors.size(), 0);
+    walk.start = start;
+    walkSector(walk, start, volume, 0);
+
+    if (walk.overflow) {
+        // Out of budget: fall back to everything the reject table allows rather than popping
+        // sectors out.
+        size_t count = 0;
+        for (size_t s = 0; s < visible.size(); ++s) {
+            visible[s] = level.reject.canSee(start, static_cast<int>(s)) ? 1 : 0;
+            count += visible[s];
+        }
+        return count;
+    }
+    size_t count = 0;
+    for (uint8_t v : visible)
+        count += v;
+    return count;
+}
@@ -0,0 +1,14 @@
+// Portals.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Level;
+
+// Starting in the eye's sector, clips the view frustum through each portal edge it can see
+// and marks every sector reached. visible is resized to the sector count. Returns the
+// number of visible sectors, or 0 (with nothing marked) when the eye is outside the map.
+size_t computeVisibleSectors(const Level& level, const float eye[3], const float viewProj[16],
+                             std::vector<uint8_t>& visible);
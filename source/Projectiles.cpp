@@ -0,0 +1,96 @@
+// Projectiles.cpp
+#include "Projectiles.h"
+#include "Simd.h"
+#include <cstring>
+
+ProjectileSystem::ProjectileSystem()
+    : x(kCapacity), y(kCapacity), z(kCapacity),
+      vx(kCapacity), vy(kCapacity), vz(kCapacity),
+      prevX(kCapacity), prevY(kCapacity), prevZ(kCapacity),
+      flags(kCapacity), nearPlayer(kCapacity) {}
+
+bool ProjectileSystem::spawn(float px, float py, float pz, float pvx, float pvy, float pvz, bool player) {
+    if (count == kCapacity)
+        return false;
+    const size_t i = count++;
+    x[i] = px;
+    y[i] = py;
+    z[i] = pz;
+    vx[i] = pvx;
+    vy[i] = pvy;
+    vz[i] = pvz;
+    prevX[i] = px;
+    prevY[i] = py;
+    prevZ[i] = pz;
+    flags[i] = player ? ProjectileFromPlayer : 0;
+    return true;
+}
+
+void ProjectileSystem::compact() {
+    size_t i = 0;
+    while (i < count) {
+        if (alive(i)) {
+            ++i;
+            continue;
+        }
+        const size_t last = --count;
+        x[i] = x[last];
+        y[i] = y[last];
+        z[i] = z[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        vz[i] = vz[last];
+        prevX[i] = prevX[last];
+        prevY[i] = prevY[last];
+        prevZ[i] = prevZ[last];
+        flags[i] = flags[last];
+    }
+}
+
+void ProjectileSystem::saveHistory() {
+    std::memcpy(prevX.data(), x.data(), count * sizeof(float));
+    std::memcpy(prevY.data(), y.data(), count * sizeof(float));
+    std::memcpy(prevZ.data(), z.data(), count * sizeof(float));
+}
+
+void projectilesIntegrateZ(ProjectileSystem& pool, float dt) {
+    float* z = pool.z.data();
+    const float* vz = pool.vz.data();
+    const simd4f step = simdSplat(dt);
+    size_t i = 0;
+    for (; i + 4 <= pool.count; i += 4)
+        simdStore(z + i, simdMadd(simdLoad(vz + i), step, simdLoad(z + i)));
+    for (; i < pool.count; ++i)
+        z[i] += vz[i] * dt;
+}
+
+void projectilesNearCircle(const ProjectileSystem& pool, float cx, float cy, float radius, float dt, uint8_t* mask) {
+    // Reachable if |p - c| <= |v| dt + radius. Squaring with (a + b)^2 <= 2a^2 + 2b^2 avoids the sqrt.
+    const float* x = pool.x.data();
+    const float* y = pool.y.data();
+    const float* vx = pool.vx.data();
+    const float* vy = pool.vy.data();
+    const simd4f centerX = simdSplat(cx);
+    const simd4f centerY = simdSplat(cy);
+    const simd4f twoDt2 = simdSplat(2.0f * dt * dt);
+    const simd4f twoR2 = simdSplat(2.0f * radius * radius);
+    size_t i = 0;
+    for (; i + 4 <= pool.count; i += 4) {
+        const simd4f dx = simdSub(simdLoad(x + i), centerX);
+        const simd4f dy = simdSub(simdLoad(y + i), centerY);
+        const simd4f dist2 = simdMadd(dx, dx, simdMul(dy, dy));
+        const simd4f vxs = simdLoad(vx + i);
+        const simd4f vys = simdLoad(vy + i);
+        const simd4f speed2 = simdMadd(vxs, vxs, simdMul(vys, vys));
+        const simd4f reach2 = simdMadd(speed2, twoDt2, twoR2);
+        const int far = simdMoveMask(simdLess(reach2, dist2));
+        for (int lane = 0; lane < 4; ++lane)
+            mask[i + lane] = (far & (1 << lane)) ? 0 : 1;
+    }
+    for (; i < pool.count; ++i) {
+        const float dx = x[i] - cx;
+        const float dy = y[i] - cy;
+        const float speed2 = vx[i] * vx[i] + vy[i] * vy[i];
+        mask[i] = (dx * dx + dy * dy <= speed2 * 2.0f * dt * dt + 2.0f * radius * radius) ? 1 : 0;
+    }
+}
@@ -1,21 +1,51 @@
 // Projectiles.h
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
-struct Projectile {
-    float x, y, z;
-    float vx, vy, vz;
-    bool fromPlayer;
-    bool alive;
+enum ProjectileFlags : uint8_t {
+    ProjectileFromPlayer = 1 << 0,
+    ProjectileDead       = 1 << 1, // dropped by the next compact()
 };
 
+// Fixed-capacity SoA pool. Live projectiles are packed into [0, count); compact() fills
+// holes by swapping in the last entry, so nothing allocates once the pool exists.
 struct ProjectileSystem {
-    std::vector<Projectile> active;
+    static constexpr size_t kCapacity = 16384;
+
+    ProjectileSystem();
+
+    // Returns false (and drops the shot) when the pool is full.
+    bool spawn(float px, float py, float pz, float pvx, float pvy, float pvz, bool fromPlayer);
+    void kill(size_t i) { flags[i] |= ProjectileDead; }
+    bool alive(size_t i) const { return (flags[i] & ProjectileDead) == 0; }
+    bool fromPlayer(size_t i) const { return (flags[i] & ProjectileFromPlayer) != 0; }
+    void compact();
+    void clear() { count = 0; }
+    // Copies positions into prevX/Y/Z at the start of a tick for render interpolation.
+    void saveHistory();
+
+    size_t count = 0;
+    std::vector<float> x, y, z;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> prevX, prevY, prevZ;
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> nearPlayer; // per-tick scratch for projectilesNearCircle
 };
 
+// z += vz * dt for every live slot; x/y move through the swept collision pass.
+void projectilesIntegrateZ(ProjectileSystem& pool, float dt);
+// mask[i] = 1 when projectile i could touch the circle (cx, cy, radius) during a step of dt.
+// Conservative, so a 0 lets the caller skip the exact sweep.
+void projectilesNearCircle(const ProjectileSystem& pool, float cx, float cy, float radius, float dt, uint8_t* mask);
+
 struct EnemyWizard {
     float x, y, z;
-    float cooldown;
+    float cooldown; // seconds before the first shot; the AI scheduler times the rest
     bool alive;
+    float prevX = 0.0f; // position before the current tick, for render interpolation
+    float prevY = 0.0f;
+    int32_t spawner = -1; // index into EditorState::spawners, or -1 for a placed enemy
 };
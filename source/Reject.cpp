@@ -0,0 +1,177 @@
+// Reject.cpp
+#include "Reject.h"
+#include "Jobs.h"
+#include "Level.h"
+#include "MapIO.h"
+#include "Platform.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+constexpr uint32_t kRejectMagic = 0x4A524D4D; // "MMRJ"
+constexpr uint16_t kRejectVersion = 1;
+constexpr float kSideEpsilon = 1e-4f;
+
+// Which side of an edge a point is on, positive inside the edge's sector.
+struct SideTest {
+    const Level& level;
+    const std::vector<float>& winding; // +1 for counter-clockwise sectors, -1 otherwise
+
+    float operator()(const LevelEdge& edge, float px, float py) const {
+        const float ax = level.vx[edge.v1], ay = level.vy[edge.v1];
+        const float bx = level.vx[edge.v2], by = level.vy[edge.v2];
+        return ((bx - ax) * (py - ay) - (by - ay) * (px - ax)) * winding[edge.sector];
+    }
+    // True when some endpoint of other lies strictly on the given side of edge.
+    bool anyOn(const LevelEdge& edge, const LevelEdge& other, bool inside) const {
+        for (int v : { other.v1, other.v2 }) {
+            const float side = (*this)(edge, level.vx[v], level.vy[v]);
+            if (inside ? side > kSideEpsilon : side < -kSideEpsilon)
+                return true;
+        }
+        return false;
+    }
+};
+
+// Marks every sector a straight line leaving `source` through one of its portals could reach.
+// A line through first portal P and later portal Q must cross Q beyond P's line and cross P
+// before Q's line; any chain of portals passing that test for every Q is kept. Intermediate
+// portals aren't checked against each other, so the answer errs towards visible.
+void buildRow(const Level& level, const SideTest& side, int source, uint64_t* row,
+              std::vector<uint8_t>& visited, std::vector<int>& stack) {
+    auto mark = [&](int s) { row[s >> 6] |= uint64_t(1) << (s & 63); };
+    mark(source);
+    const LevelSector& ls = level.sectors[source];
+    for (uint32_t p = ls.firstEdge; p < ls.firstEdge + ls.edgeCount; ++p) {
+        const LevelEdge& first = level.edges[p];
+        if (first.otherSector < 0)
+            continue;
+        std::fill(visited.begin(), visited.end(), 0);
+        visited[source] = 1;
+        visited[first.otherSector] = 1;
+        mark(first.otherSector);
+        stack.assign(1, first.otherSector);
+        while (!stack.empty()) {
+            const LevelSector& through = level.sectors[stack.back()];
+            stack.pop_back();
+            for (uint32_t q = through.firstEdge; q < through.firstEdge + through.edgeCount; ++q) {
+                const LevelEdge& next = level.edges[q];
+                if (next.otherSector < 0 || visited[next.otherSector])
+                    continue;
+                if (!side.anyOn(first, next, false) || !side.anyOn(next, first, true))
+                    continue;
+                visited[next.otherSector] = 1;
+                mark(next.otherSector);
+                stack.push_back(next.otherSector);
+            }
+        }
+    }
+}
+
+} // namespace
+
+uint64_t levelRejectKey(const Level& level) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&](const void* data, size_t size) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    };
+    mix(level.vx.data(), level.vx.size() * sizeof(float));
+    mix(level.vy.data(), level.vy.size() * sizeof(float));
+    for (const LevelEdge& edge : level.edges) {
+        const int32_t fields[4] = { edge.v1, edge.v2, edge.sector, edge.otherSector };
+        mix(fields, sizeof(fields));
+    }
+    return h;
+}
+
+void buildReject(const Level& level, RejectTable& table) {
+    const uint64_t startNs = PlatformTimeNs();
+    const size_t n = level.sectors.size();
+    table.sectorCount = n;
+    table.rowWords = (n + 63) / 64;
+    table.bits.assign(n * table.rowWords, 0);
+    table.key = levelRejectKey(level);
+
+    std::vector<float> winding(n, 1.0f);
+    for (size_t s = 0; s < n; ++s) {
+        const LevelSector& ls = level.sectors[s];
+        float area = 0.0f;
+        for (uint32_t e = ls.firstEdge; e < ls.firstEdge + ls.edgeCount; ++e) {
+            const LevelEdge& edge = level.edges[e];
+            if (edge.v1 >= 0)
+                area += level.vx[edge.v1] * level.vy[edge.v2] - level.vx[edge.v2] * level.vy[edge.v1];
+        }
+        winding[s] = area >= 0.0f ? 1.0f : -1.0f;
+    }
+    const SideTest side{ level, winding };
+
+    parallelFor(n, 8, [&](size_t begin, size_t end) {
+        std::vector<uint8_t> visited(n);
+        std::vector<int> stack;
+        for (size_t s = begin; s < end; ++s)
+            buildRow(level, side, static_cast<int>(s), table.bits.data() + s * table.rowWords, visited, stack);
+    });
+    // Sight is symmetric; OR the transpose in so neither direction rules out the other.
+    size_t visiblePairs = 0;
+    for (size_t a = 0; a < n; ++a) {
+        for (size_t b = a + 1; b < n; ++b) {
+            uint64_t& ab = table.bits[a * table.rowWords + (b >> 6)];
+            uint64_t& ba = table.bits[b * table.rowWords + (a >> 6)];
+            if (((ab >> (b & 63)) | (ba >> (a & 63))) & 1u) {
+                ab |= uint64_t(1) << (b & 63);
+                ba |= uint64_t(1) << (a & 63);
+                ++visiblePairs;
+            }
+        }
+    }
+    table.buildMs = (PlatformTimeNs() - startNs) * 1e-6;
+    std::printf("reject: %zu sectors, %zu of %zu pairs may see each other, %.2f ms\n",
+                n, visiblePairs, n * (n > 0 ? n - 1 : 0) / 2, table.buildMs);
+}
+
+bool saveReject(const char* path, const RejectTable& table) {
+    std::vector<uint8_t> file;
+    ByteWriter out{file};
+    out.u32(kRejectMagic);
+    out.u16(kRejectVersion);
+    out.u64(table.key);
+    out.u32(static_cast<uint32_t>(table.sectorCount));
+    for (uint64_t word : table.bits)
+        out.u64(word);
+    if (!PlatformWriteFile(path, file)) {
+        std::printf("reject: could not write %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+bool loadReject(const char* path, RejectTable& table) {
+    std::vector<uint8_t> file;
+    if (!PlatformReadFile(path, file))
+        return false;
+    ByteReader in{file.data(), file.data() + file.size()};
+    if (in.u32() != kRejectMagic || in.u16() != kRejectVersion) {
+        std::printf("reject: %s is not a version %u table\n", path, kRejectVersion);
+        return false;
+    }
+    const uint64_t key = in.u64();
+    const size_t n = in.u32();
+    const size_t rowWords = (n + 63) / 64;
+    if (!in.need(n * rowWords * sizeof(uint64_t))) {
+        std::printf("reject: %s is truncated\n", path);
+        return false;
+    }
+    table.key = key;
+    table.sectorCount = n;
+    table.rowWords = rowWords;
+    table.bits.resize(n * rowWords);
+    for (uint64_t& word : table.bits)
+        word = in.u64();
+    table.buildMs = 0.0;
+    return true;
+}
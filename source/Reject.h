@@ -0,0 +1,35 @@
+// Reject.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Level;
+
+// Doom's REJECT lump: one bit per sector pair, clear when no point of one sector can possibly
+// see any point of the other. Conservative, so a set bit only means "might see"; callers use
+// it to skip ray casts and portal walks that can never succeed.
+struct RejectTable {
+    size_t sectorCount = 0;
+    size_t rowWords = 0;         // uint64 words per row
+    std::vector<uint64_t> bits;  // row a, bit b
+    uint64_t key = 0;            // levelRejectKey of the level it was built for
+    double buildMs = 0.0;        // 0 when the table was kept or loaded rather than built
+
+    bool canSee(int a, int b) const {
+        if (a < 0 || b < 0 || static_cast<size_t>(a) >= sectorCount || static_cast<size_t>(b) >= sectorCount)
+            return true;
+        return (bits[a * rowWords + (static_cast<size_t>(b) >> 6)] >> (b & 63)) & 1u;
+    }
+    const uint64_t* row(int a) const { return bits.data() + a * rowWords; }
+};
+
+// Hash of the sector and portal layout; a table is valid for any level with the same key.
+uint64_t levelRejectKey(const Level& level);
+// Rows are built in parallel on the job system.
+void buildReject(const Level& level, RejectTable& table);
+// File form: "MMRJ", version, key, sector count, then the rows.
+bool saveReject(const char* path, const RejectTable& table);
+// Loads whatever table is in the file; compileLevel throws it away if the key doesn't match.
+bool loadReject(const char* path, RejectTable& table);
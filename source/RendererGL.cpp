@@ -1,6 +1,8 @@
 // RendererGL.cpp
 #include "RendererGL.h"
 #include "EditorState.h"
+#include "Culling.h"
+#include "Jobs.h"
 #include "Mesh3D.h"
 #include "Platform.h"
 #define STBI_NO_STDIO
@@ -9,6 +11,7 @@
 #define STBI_NO_THREAD_LOCALS
 #define STBI_NO_LINEAR
 #include "stb_image.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <vector>
@@ -30,11 +33,14 @@ static PFNGLUSEPROGRAMPROC          p_glUseProgram          = nullptr;
 static PFNGLUNIFORM4FPROC           p_glUniform4f           = nullptr;
 static PFNGLBINDBUFFERPROC          p_glBindBuffer          = nullptr;
 static PFNGLBUFFERDATAPROC          p_glBufferData          = nullptr;
+static PFNGLBUFFERSUBDATAPROC       p_glBufferSubData       = nullptr;
 static PFNGLENABLEVERTEXATTRIBARRAYPROC p_glEnableVertexAttribArray = nullptr;
 static PFNGLVERTEXATTRIBPOINTERPROC p_glVertexAttribPointer = nullptr;
 static PFNGLDISABLEVERTEXATTRIBARRAYPROC p_glDisableVertexAttribArray = nullptr;
 static PFNGLUNIFORMMATRIX4FVPROC    p_glUniformMatrix4fv    = nullptr;
 static PFNGLUNIFORM1IPROC           p_glUniform1i           = nullptr;
+static PFNGLUNIFORM1FVPROC          p_glUniform1fv          = nullptr;
+static PFNGLVERTEXATTRIB4FPROC      p_glVertexAttrib4f      = nullptr;
 static PFNGLACTIVETEXTUREPROC       p_glActiveTexture       = nullptr;
 static PFNGLCREATESHADERPROC        p_glCreateShader        = nullptr;
 static PFNGLSHADERSOURCEPROC        p_glShaderSource        = nullptr;
@@ -57,11 +63,14 @@ static PFNGLGENBUFFERSPROC          p_glGenBuffers          = nullptr;
 #define glUniform4f p_glUniform4f
 #define glBindBuffer p_glBindBuffer
 #define glBufferData p_glBufferData
+#define glBufferSubData p_glBufferSubData
 #define glEnableVertexAttribArray p_glEnableVertexAttribArray
 #define glVertexAttribPointer p_glVertexAttribPointer
 #define glDisableVertexAttribArray p_glDisableVertexAttribArray
 #define glUniformMatrix4fv p_glUniformMatrix4fv
 #define glUniform1i p_glUniform1i
+#define glUniform1fv p_glUniform1fv
+#define glVertexAttrib4f p_glVertexAttrib4f
 #define glActiveTexture p_glActiveTexture
 #define glCreateShader p_glCreateShader
 #define glShaderSource p_glShaderSource
@@ -85,11 +94,14 @@ static bool loadGLFunctions() {
     p_glUniform4f            = reinterpret_cast<PFNGLUNIFORM4FPROC>(SDL_GL_GetProcAddress("glUniform4f"));
     p_glBindBuffer           = reinterpret_cast<PFNGLBINDBUFFERPROC>(SDL_GL_GetProcAddress("glBindBuffer"));
     p_glBufferData           = reinterpret_cast<PFNGLBUFFERDATAPROC>(SDL_GL_GetProcAddress("glBufferData"));
+    p_glBufferSubData        = reinterpret_cast<PFNGLBUFFERSUBDATAPROC>(SDL_GL_GetProcAddress("glBufferSubData"));
     p_glEnableVertexAttribArray = reinterpret_cast<PFNGLENABLEVERTEXATTRIBARRAYPROC>(SDL_GL_GetProcAddress("glEnableVertexAttribArray"));
     p_glVertexAttribPointer  = reinterpret_cast<PFNGLVERTEXATTRIBPOINTERPROC>(SDL_GL_GetProcAddress("glVertexAttribPointer"));
     p_glDisableVertexAttribArray = reinterpret_cast<PFNGLDISABLEVERTEXATTRIBARRAYPROC>(SDL_GL_GetProcAddress("glDisableVertexAttribArray"));
     p_glUniformMatrix4fv     = reinterpret_cast<PFNGLUNIFORMMATRIX4FVPROC>(SDL_GL_GetProcAddress("glUniformMatrix4fv"));
     p_glUniform1i            = reinterpret_cast<PFNGLUNIFORM1IPROC>(SDL_GL_GetProcAddress("glUniform1i"));
+    p_glUniform1fv           = reinterpret_cast<PFNGLUNIFORM1FVPROC>(SDL_GL_GetProcAddress("glUniform1fv"));
+    p_glVertexAttrib4f       = reinterpret_cast<PFNGLVERTEXATTRIB4FPROC>(SDL_GL_GetProcAddress("glVertexAttrib4f"));
     p_glActiveTexture        = reinterpret_cast<PFNGLACTIVETEXTUREPROC>(SDL_GL_GetProcAddress("glActiveTexture"));
     p_glCreateShader         = reinterpret_cast<PFNGLCREATESHADERPROC>(SDL_GL_GetProcAddress("glCreateShader"));
     p_glShaderSource         = reinterpret_cast<PFNGLSHADERSOURCEPROC>(SDL_GL_GetProcAddress("glShaderSource"));
@@ -107,8 +119,8 @@ static bool loadGLFunctions() {
     p_glGenBuffers           = reinterpret_cast<PFNGLGENBUFFERSPROC>(SDL_GL_GetProcAddress("glGenBuffers"));
 
     return p_glDeleteBuffers && p_glDeleteProgram && p_glUseProgram && p_glUniform4f &&
-           p_glBindBuffer && p_glBufferData && p_glEnableVertexAttribArray && p_glVertexAttribPointer &&
-           p_glDisableVertexAttribArray && p_glUniformMatrix4fv && p_glUniform1i && p_glActiveTexture &&
+           p_glBindBuffer && p_glBufferData && p_glBufferSubData && p_glEnableVertexAttribArray && p_glVertexAttribPointer &&
+           p_glDisableVertexAttribArray && p_glUniformMatrix4fv && p_glUniform1i && p_glUniform1fv && p_glVertexAttrib4f && p_glActiveTexture &&
            p_glCreateShader && p_glShaderSource && p_glCompileShader && p_glGetShaderiv &&
            p_glGetShaderInfoLog && p_glDeleteShader && p_glCreateProgram && p_glAttachShader &&
            p_glLinkProgram && p_glGetProgramiv && p_glGetProgramInfoLog && p_glGetAttribLocation &&
@@ -242,31 +254,41 @@ static GLuint createFallbackTexture() {
     return tex;
 }
 
-GLuint loadTextureFromPNG(const char* path) {
-    stbi_set_flip_vertically_on_load(1);
+namespace {
+
+struct DecodedImage {
+    stbi_uc* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+};
+
+// File read and PNG decode only; safe to run on a job thread.
+DecodedImage decodePNG(const char* path) {
+    DecodedImage image;
     std::vector<unsigned char> fileData;
     if (!PlatformReadFile(path, fileData) || fileData.empty()) {
         std::printf("Failed to read texture: %s (using fallback)\n", path);
-        return createFallbackTexture();
+        return image;
     }
 
-    int width = 0;
-    int height = 0;
-    int comp = 0;
     if (fileData.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
         std::printf("Texture too large to load: %s (using fallback)\n", path);
-        return createFallbackTexture();
+        return image;
     }
 
-    stbi_uc* pixels = stbi_load_from_memory(fileData.data(), static_cast<int>(fileData.size()), &width, &height, &comp, STBI_rgb_alpha);
-    if (!pixels) {
+    int comp = 0;
+    image.pixels = stbi_load_from_memory(fileData.data(), static_cast<int>(fileData.size()),
+                                         &image.width, &image.height, &comp, STBI_rgb_alpha);
+    if (!image.pixels) {
         const char* reason = stbi_failure_reason();
         std::printf("stbi_load_from_memory failed for %s: %s (using fallback)\n", path, reason ? reason : "unknown");
-        return createFallbackTexture();
     }
+    return image;
+}
 
+GLuint uploadTexture(const DecodedImage& image) {
     auto isPowerOfTwo = [](int n) { return (n & (n - 1)) == 0; };
-    bool pow2 = width > 0 && height > 0 && isPowerOfTwo(width) && isPowerOfTwo(height);
+    bool pow2 = image.width > 0 && image.height > 0 && isPowerOfTwo(image.width) && isPowerOfTwo(image.height);
 
     GLuint tex = 0;
     glGenTextures(1, &tex);
@@ -278,15 +300,94 @@ GLuint loadTextureFromPNG(const char* path) {
     GLint wrapMode = (pow2) ? GL_REPEAT : GL_CLAMP_TO_EDGE;
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(width), static_cast<GLsizei>(height), 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(image.width), static_cast<GLsizei>(image.height), 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
     glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
 
-    stbi_image_free(pixels);
+} // namespace
+
+void loadTexturesFromPNG(const char* const* paths, size_t count, GLuint* outTextures) {
+    // Set once up front; the decode jobs only read it.
+    stbi_set_flip_vertically_on_load(1);
+    std::vector<DecodedImage> images(count);
+    parallelFor(count, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            images[i] = decodePNG(paths[i]);
+    });
+
+    // GL calls stay on the thread that owns the context.
+    for (size_t i = 0; i < count; ++i) {
+        if (!images[i].pixels) {
+            outTextures[i] = createFallbackTexture();
+            continue;
+        }
+        outTextures[i] = uploadTexture(images[i]);
+        stbi_image_free(images[i].pixels);
+        std::printf("Loaded texture %s (%dx%d)\n", paths[i], images[i].width, images[i].height);
+    }
+}
 
-    std::printf("Loaded texture %s (%dx%d)\n", path, width, height);
+GLuint loadTextureFromPNG(const char* path) {
+    GLuint tex = 0;
+    loadTexturesFromPNG(&path, 1, &tex);
     return tex;
 }
 
+bool TransientVertexBuffer::init(size_t capacityBytes) {
+    glGenBuffers(kBufferCount, m_buffers);
+    for (int i = 0; i < kBufferCount; ++i) {
+        if (!m_buffers[i])
+            return false;
+        glBindBuffer(GL_ARRAY_BUFFER, m_buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacityBytes), nullptr, GL_DYNAMIC_DRAW);
+        m_capacity[i] = capacityBytes;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_index = 0;
+    m_offset = 0;
+    return true;
+}
+
+void TransientVertexBuffer::destroy() {
+    for (int i = 0; i < kBufferCount; ++i) {
+        if (m_buffers[i]) glDeleteBuffers(1, &m_buffers[i]);
+        m_buffers[i] = 0;
+        m_capacity[i] = 0;
+    }
+}
+
+void TransientVertexBuffer::nextFrame() {
+    m_index = (m_index + 1) % kBufferCount;
+    m_offset = 0;
+}
+
+void TransientVertexBuffer::grow(size_t minBytes) {
+    // Only reached when a frame outgrows the buffer; steady-state frames never reallocate.
+    size_t newCapacity = m_capacity[m_index] ? m_capacity[m_index] : 4096;
+    while (newCapacity < minBytes) newCapacity *= 2;
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffers[m_index]);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(newCapacity), nullptr, GL_DYNAMIC_DRAW);
+    m_capacity[m_index] = newCapacity;
+    m_offset = 0;
+    ++m_reallocations;
+    std::printf("Transient vertex buffer %d grown to %zu KB\n", m_index, newCapacity / 1024);
+}
+
+size_t TransientVertexBuffer::write(const void* data, size_t bytes) {
+    const size_t alignment = 16;
+    size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+    if (offset + bytes > m_capacity[m_index]) {
+        // Earlier draws this frame have already been issued, so the old storage can be orphaned.
+        grow(m_capacity[m_index] * 2 > bytes ? m_capacity[m_index] * 2 : bytes);
+        offset = 0;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffers[m_index]);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes), data);
+    m_offset = offset + bytes;
+    return offset;
+}
+
 RendererGL::RendererGL()
     : m_width(1280)
     , m_height(720)
@@ -297,20 +398,25 @@ RendererGL::RendererGL()
     , m_program3D(0)
     , m_attrPos3D(-1)
     , m_attrUV3D(-1)
+    , m_attrMover3D(-1)
     , m_uniformMVP(-1)
+    , m_uniformMoverOffset(-1)
     , m_uniformTex(-1)
-    , m_vbo(0)
     , m_vbo3DPos(0)
     , m_vbo3DUV(0)
+    , m_vbo3DMover(0)
     , m_ibo3D(0)
 {
     m_camera.zoom = 1.0f;
+    m_recording = &m_packets[0];
 }
 
 RendererGL::~RendererGL() {
-    if (m_vbo) glDeleteBuffers(1, &m_vbo);
+    stopRenderThread();
+    m_transient.destroy();
     if (m_vbo3DPos) glDeleteBuffers(1, &m_vbo3DPos);
     if (m_vbo3DUV) glDeleteBuffers(1, &m_vbo3DUV);
+    if (m_vbo3DMover) glDeleteBuffers(1, &m_vbo3DMover);
     if (m_ibo3D) glDeleteBuffers(1, &m_ibo3D);
     if (m_program) glDeleteProgram(m_program);
     if (m_program3D) glDeleteProgram(m_program3D);
@@ -332,34 +438,75 @@ bool RendererGL::init(SDL_Window* window) {
     if (!initGL())
         return false;
 
-    glGenBuffers(1, &m_vbo);
-    if (!m_vbo) {
-        std::printf("Failed to create VBO for line rendering\n");
+    if (!m_transient.init(2 * 1024 * 1024)) {
+        std::printf("Failed to create transient vertex buffers\n");
         return false;
     }
 
     glGenBuffers(1, &m_vbo3DPos);
     glGenBuffers(1, &m_vbo3DUV);
+    glGenBuffers(1, &m_vbo3DMover);
     glGenBuffers(1, &m_ibo3D);
-    if (!m_vbo3DPos || !m_vbo3DUV || !m_ibo3D) {
+    if (!m_vbo3DPos || !m_vbo3DUV || !m_vbo3DMover || !m_ibo3D) {
         std::printf("Failed to create buffers for 3D rendering\n");
         return false;
     }
 
     glViewport(0, 0, m_width, m_height);
+    m_viewportW = m_width;
+    m_viewportH = m_height;
     return true;
 }
 
 void RendererGL::resize(int width, int height) {
+    // Viewport is applied on the GL side when the next packet carries the new size.
     m_width = width;
     m_height = height;
-    glViewport(0, 0, width, height);
 }
 
 void RendererGL::beginFrame() {
-    glClearColor(0.05f, 0.05f, 0.1f, 1.0f);
-    glDisable(GL_DEPTH_TEST); // 2D editor rendering does not need depth
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    float* clear = m_recording->clearColor;
+    clear[0] = 0.05f;
+    clear[1] = 0.05f;
+    clear[2] = 0.1f;
+    clear[3] = 1.0f;
+    m_layer = RenderLayer::Auto;
+}
+
+uint64_t RendererGL::makeKey(RenderLayer layer, RenderPass pass, uint8_t program, GLuint texture, float depth) {
+    // layer:4 | pass:2 | then either program:4 texture:12 depth:16 (opaque, front-to-back)
+    // or depth:16 program:4 texture:12 (translucent, back-to-front) | sequence:26
+    const float maxDepth = 512.0f;
+    float d = depth < 0.0f ? 0.0f : (depth > maxDepth ? maxDepth : depth);
+    uint64_t depthBits = static_cast<uint64_t>(d * (65535.0f / maxDepth)) & 0xFFFF;
+    uint64_t programBits = program & 0xF;
+    uint64_t textureBits = texture & 0xFFF;
+    uint64_t key = (static_cast<uint64_t>(layer) & 0xF) << 60;
+    key |= (static_cast<uint64_t>(pass) & 0x3) << 58;
+    if (pass == RenderPass::Opaque) {
+        key |= programBits << 54 | textureBits << 42 | depthBits << 26;
+    } else {
+        key |= (0xFFFF - depthBits) << 42 | programBits << 38 | textureBits << 26;
+    }
+    key |= static_cast<uint64_t>(m_recording->commands.size()) & 0x3FFFFFF;
+    return key;
+}
+
+void RendererGL::record2D(RenderLayer layer, GLenum primitive, const float* verts, size_t floatCount,
+                          float r, float g, float b, float a, uint8_t flags) {
+    RenderCommand cmd;
+    cmd.key = makeKey(resolveLayer(layer), RenderPass::Opaque, 0, 0, 0.0f);
+    cmd.program = 0;
+    cmd.flags = flags;
+    cmd.primitive = primitive;
+    cmd.color[0] = r;
+    cmd.color[1] = g;
+    cmd.color[2] = b;
+    cmd.color[3] = a;
+    cmd.first = static_cast<uint32_t>(m_recording->verts.size());
+    cmd.count = static_cast<uint32_t>(floatCount / 2);
+    m_recording->verts.insert(m_recording->verts.end(), verts, verts + floatCount);
+    m_recording->commands.push_back(cmd);
 }
 
 void RendererGL::drawLine2D(float x1, float y1, float x2, float y2, float r, float g, float b) {
@@ -370,20 +517,7 @@ void RendererGL::drawLine2D(float x1, float y1, float x2, float y2, float r, flo
         worldToClipX(x1), worldToClipY(y1),
         worldToClipX(x2), worldToClipY(y2),
     };
-
-    glUseProgram(m_program);
-    glUniform4f(m_uniformColor, r, g, b, 1.0f);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_DYNAMIC_DRAW);
-
-    glEnableVertexAttribArray(m_attrPos);
-    glVertexAttribPointer(m_attrPos, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (const void*)0);
-
-    glDrawArrays(GL_LINES, 0, 2);
-
-    glDisableVertexAttribArray(m_attrPos);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    record2D(RenderLayer::Lines, GL_LINES, verts, 4, r, g, b, 1.0f, 0);
 }
 
 void RendererGL::drawPoint2D(float x, float y, float size, float r, float g, float b) {
@@ -402,32 +536,23 @@ void RendererGL::drawPoint2D(float x, float y, float size, float r, float g, flo
     const float radiusX = size * m_camera.zoom / halfWidth;
     const float radiusY = size * m_camera.zoom / halfHeight;
 
+    // Emitted as a triangle list rather than a fan so consecutive points can share one draw.
     constexpr int segments = 20;
-    float verts[(segments + 2) * 2];
-    verts[0] = cx;
-    verts[1] = cy;
-
-    for (int i = 0; i <= segments; ++i) {
+    float verts[segments * 6];
+    float prevX = cx + radiusX;
+    float prevY = cy;
+    for (int i = 1; i <= segments; ++i) {
         float angle = (static_cast<float>(i) / segments) * 6.28318530718f;
         float xPos = cx + std::cos(angle) * radiusX;
         float yPos = cy + std::sin(angle) * radiusY;
-        verts[(i + 1) * 2 + 0] = xPos;
-        verts[(i + 1) * 2 + 1] = yPos;
+        float* tri = &verts[(i - 1) * 6];
+        tri[0] = cx;    tri[1] = cy;
+        tri[2] = prevX; tri[3] = prevY;
+        tri[4] = xPos;  tri[5] = yPos;
+        prevX = xPos;
+        prevY = yPos;
     }
-
-    glUseProgram(m_program);
-    glUniform4f(m_uniformColor, r, g, b, 1.0f);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_DYNAMIC_DRAW);
-
-    glEnableVertexAttribArray(m_attrPos);
-    glVertexAttribPointer(m_attrPos, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (const void*)0);
-
-    glDrawArrays(GL_TRIANGLE_FAN, 0, segments + 2);
-
-    glDisableVertexAttribArray(m_attrPos);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    record2D(RenderLayer::Points, GL_TRIANGLES, verts, segments * 6, r, g, b, 1.0f, 0);
 }
 
 void RendererGL::drawSectorFill(const Sector& sector, const EditorState& state,
@@ -450,76 +575,47 @@ void RendererGL::drawSectorFill(const Sector& sector, const EditorState& state,
 
     std::vector<uint16_t> triIdx;
     bool triangulated = earClip2D(poly, localIdx, triIdx);
+    if (!triangulated || triIdx.empty()) {
+        // Fan fallback, expanded to a triangle list.
+        triIdx.clear();
+        for (uint16_t i = 1; i + 1 < static_cast<uint16_t>(poly.size()); ++i) {
+            triIdx.push_back(0);
+            triIdx.push_back(i);
+            triIdx.push_back(static_cast<uint16_t>(i + 1));
+        }
+    }
 
     std::vector<float> verts;
-    GLenum primitive = GL_TRIANGLES;
-    if (triangulated && !triIdx.empty()) {
-        verts.reserve(triIdx.size() * 2);
-        for (uint16_t i : triIdx) {
-            const ClipVertex& p = poly[i];
-            verts.push_back(p.x);
-            verts.push_back(p.y);
-        }
-    } else {
-        primitive = GL_TRIANGLE_FAN;
-        verts.reserve(poly.size() * 2);
-        for (const auto& p : poly) {
-            verts.push_back(p.x);
-            verts.push_back(p.y);
-        }
+    verts.reserve(triIdx.size() * 2);
+    for (uint16_t i : triIdx) {
+        const ClipVertex& p = poly[i];
+        verts.push_back(p.x);
+        verts.push_back(p.y);
     }
 
     if (verts.empty())
         return;
 
-    glUseProgram(m_program);
-    glUniform4f(m_uniformColor, r, g, b, a);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * verts.size(), verts.data(), GL_DYNAMIC_DRAW);
-
-    glEnableVertexAttribArray(m_attrPos);
-    glVertexAttribPointer(m_attrPos, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (const void*)0);
-
-    glDrawArrays(primitive, 0, static_cast<GLsizei>(verts.size() / 2));
-
-    glDisableVertexAttribArray(m_attrPos);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    record2D(RenderLayer::Fills, GL_TRIANGLES, verts.data(), verts.size(), r, g, b, a, 0);
 }
 
-void RendererGL::drawBillboard3D(const Camera3D& cam, float x, float y, float z, float size, GLuint tex, float r, float g, float b) {
-    // Billboard uses camera-facing basis (yaw + pitch) so it stays anchored when looking up/down.
-    glEnable(GL_DEPTH_TEST);
-
+static void cameraBasis(const Camera3D& cam, float forward[3], float right[3], float up[3]) {
     const float cosYaw = std::cos(cam.yaw);
     const float sinYaw = std::sin(cam.yaw);
     const float cosPitch = std::cos(cam.pitch);
     const float sinPitch = std::sin(cam.pitch);
-    float forwardX = cosPitch * sinYaw;
-    float forwardY = cosPitch * cosYaw;
-    float forwardZ = sinPitch;
-    float rightX = cosYaw;
-    float rightY = -sinYaw;
-    float rightZ = 0.0f;
-    float upX = -sinPitch * sinYaw;
-    float upY = -sinPitch * cosYaw;
-    float upZ = cosPitch;
-
-    float hs = size * 0.5f;
-    float positions[12] = {
-        x - rightX * hs + upX * hs, y - rightY * hs + upY * hs, z + upZ * hs, // top-left
-        x + rightX * hs + upX * hs, y + rightY * hs + upY * hs, z + upZ * hs, // top-right
-        x + rightX * hs - upX * hs, y + rightY * hs - upY * hs, z - upZ * hs, // bottom-right
-        x - rightX * hs - upX * hs, y - rightY * hs - upY * hs, z - upZ * hs, // bottom-left
-    };
-    float uvs[8] = {
-        0.0f, 1.0f,
-        1.0f, 1.0f,
-        1.0f, 0.0f,
-        0.0f, 0.0f
-    };
-    uint16_t indices[6] = {0,1,2, 0,2,3};
+    forward[0] = cosPitch * sinYaw;
+    forward[1] = cosPitch * cosYaw;
+    forward[2] = sinPitch;
+    right[0] = cosYaw;
+    right[1] = -sinYaw;
+    right[2] = 0.0f;
+    up[0] = -sinPitch * sinYaw;
+    up[1] = -sinPitch * cosYaw;
+    up[2] = cosPitch;
+}
 
+void RendererGL::viewProjection(const Camera3D& cam, float out[16]) const {
     float aspect = (m_height != 0) ? static_cast<float>(m_width) / static_cast<float>(m_height) : 1.0f;
     const float fov = 70.0f * 3.1415926535f / 180.0f;
     float f = 1.0f / std::tan(fov * 0.5f);
@@ -533,146 +629,234 @@ void RendererGL::drawBillboard3D(const Camera3D& cam, float x, float y, float z,
         0, 0, (2 * farPlane * nearPlane) / (nearPlane - farPlane), 0
     };
 
+    float forward[3], right[3], up[3];
+    cameraBasis(cam, forward, right, up);
+
     float view[16] = {
-        rightX, upX, -forwardX, 0,
-        rightY, upY, -forwardY, 0,
-        rightZ, upZ, -forwardZ, 0,
-        0,      0,    0,        1
+        right[0], up[0], -forward[0], 0,
+        right[1], up[1], -forward[1], 0,
+        right[2], up[2], -forward[2], 0,
+        0,        0,     0,           1
     };
 
-    view[12] = -(cam.x * rightX + cam.y * rightY + cam.z * rightZ);
-    view[13] = -(cam.x * upX + cam.y * upY + cam.z * upZ);
-    view[14] =  (cam.x * forwardX + cam.y * forwardY + cam.z * forwardZ);
+    view[12] = -(cam.x * right[0] + cam.y * right[1] + cam.z * right[2]);
+    view[13] = -(cam.x * up[0] + cam.y * up[1] + cam.z * up[2]);
+    view[14] =  (cam.x * forward[0] + cam.y * forward[1] + cam.z * forward[2]);
 
-    float mvp[16];
-    for (int col = 0; col < 4; ++col) {
-        for (int row = 0; row < 4; ++row) {
-            mvp[col * 4 + row] =
-                proj[0 * 4 + row] * view[col * 4 + 0] +
-                proj[1 * 4 + row] * view[col * 4 + 1] +
-                proj[2 * 4 + row] * view[col * 4 + 2] +
-                proj[3 * 4 + row] * view[col * 4 + 3];
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            out[c * 4 + r] =
+                proj[0 * 4 + r] * view[c * 4 + 0] +
+                proj[1 * 4 + r] * view[c * 4 + 1] +
+                proj[2 * 4 + r] * view[c * 4 + 2] +
+                proj[3 * 4 + r] * view[c * 4 + 3];
         }
     }
-
-    glUseProgram(m_program3D);
-    glUniformMatrix4fv(m_uniformMVP, 1, GL_FALSE, mvp);
-    glUniform1i(m_uniformTex, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex ? tex : m_texProjectileSprite);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DPos);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(m_attrPos3D);
-    glVertexAttribPointer(m_attrPos3D, 3, GL_FLOAT, GL_FALSE, 0, (const void*)0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DUV);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(uvs), uvs, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(m_attrUV3D);
-    glVertexAttribPointer(m_attrUV3D, 2, GL_FLOAT, GL_FALSE, 0, (const void*)0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo3D);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_DYNAMIC_DRAW);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
-
-    glDisableVertexAttribArray(m_attrPos3D);
-    glDisableVertexAttribArray(m_attrUV3D);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glDisable(GL_BLEND);
 }
 
-void RendererGL::drawMesh3D(const Mesh3D& mesh, const Camera3D& cam) {
-    glEnable(GL_DEPTH_TEST);
-    glClearColor(0.02f, 0.02f, 0.05f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+uint32_t RendererGL::frameMatrix(const Camera3D& cam) {
+    float mvp[16];
+    viewProjection(cam, mvp);
+
+    // All 3D draws in a frame normally share one camera; reuse the last matrix when it matches.
+    std::vector<float>& matrices = m_recording->matrices;
+    const size_t count = matrices.size() / 16;
+    if (count > 0 && std::memcmp(&matrices[(count - 1) * 16], mvp, sizeof(mvp)) == 0)
+        return static_cast<uint32_t>(count - 1);
+    matrices.insert(matrices.end(), mvp, mvp + 16);
+    return static_cast<uint32_t>(count);
+}
 
-    float aspect = (m_height != 0) ? static_cast<float>(m_width) / static_cast<float>(m_height) : 1.0f;
-    const float fov = 70.0f * 3.1415926535f / 180.0f;
-    float f = 1.0f / std::tan(fov * 0.5f);
-    const float nearPlane = 0.05f;
-    const float farPlane = 500.0f;
+void RendererGL::drawBillboard3D(const Camera3D& cam, float x, float y, float z, float size, GLuint tex, float r, float g, float b) {
+    // Billboard uses camera-facing basis (yaw + pitch) so it stays anchored when looking up/down.
+    float forward[3], right[3], up[3];
+    cameraBasis(cam, forward, right, up);
 
-    float proj[16] = {
-        f / aspect, 0, 0, 0,
-        0, f, 0, 0,
-        0, 0, (farPlane + nearPlane) / (nearPlane - farPlane), -1,
-        0, 0, (2 * farPlane * nearPlane) / (nearPlane - farPlane), 0
+    float hs = size * 0.5f;
+    const float tlX = x - right[0] * hs + up[0] * hs, tlY = y - right[1] * hs + up[1] * hs, tlZ = z + up[2] * hs;
+    const float trX = x + right[0] * hs + up[0] * hs, trY = y + right[1] * hs + up[1] * hs, trZ = z + up[2] * hs;
+    const float brX = x + right[0] * hs - up[0] * hs, brY = y + right[1] * hs - up[1] * hs, brZ = z - up[2] * hs;
+    const float blX = x - right[0] * hs - up[0] * hs, blY = y - right[1] * hs - up[1] * hs, blZ = z - up[2] * hs;
+    // Interleaved x,y,z,u,v; two triangles so sprites sharing a texture batch into one draw.
+    const float verts[30] = {
+        tlX, tlY, tlZ, 0.0f, 1.0f,
+        trX, trY, trZ, 1.0f, 1.0f,
+        brX, brY, brZ, 1.0f, 0.0f,
+        tlX, tlY, tlZ, 0.0f, 1.0f,
+        brX, brY, brZ, 1.0f, 0.0f,
+        blX, blY, blZ, 0.0f, 0.0f,
     };
 
-    const float cosYaw = std::cos(cam.yaw);
-    const float sinYaw = std::sin(cam.yaw);
-    const float cosPitch = std::cos(cam.pitch);
-    const float sinPitch = std::sin(cam.pitch);
-    float forwardX = cosPitch * sinYaw;
-    float forwardY = cosPitch * cosYaw;
-    float forwardZ = sinPitch;
+    const float depth = (x - cam.x) * forward[0] + (y - cam.y) * forward[1] + (z - cam.z) * forward[2];
+    GLuint texture = tex ? tex : m_texProjectileSprite;
+
+    RenderCommand cmd;
+    cmd.key = makeKey(resolveLayer(RenderLayer::World), RenderPass::Translucent, 1, texture, depth);
+    cmd.program = 1;
+    cmd.flags = CmdDepthTest | CmdBlend;
+    cmd.primitive = GL_TRIANGLES;
+    cmd.texture = texture;
+    cmd.color[0] = r;
+    cmd.color[1] = g;
+    cmd.color[2] = b;
+    cmd.matrix = frameMatrix(cam);
+    cmd.first = static_cast<uint32_t>(m_recording->verts.size());
+    cmd.count = 6;
+    m_recording->verts.insert(m_recording->verts.end(), verts, verts + 30);
+    m_recording->commands.push_back(cmd);
+}
 
-    float rightX = cosYaw;
-    float rightY = -sinYaw;
-    float rightZ = 0.0f;
+void RendererGL::setMoverOffsets(const float* offsets, size_t count) {
+    count = std::min<size_t>(count, kMaxSectorMovers);
+    std::copy(offsets, offsets + count, m_recording->moverOffsets + 1);
+}
 
-    float upX = -sinPitch * sinYaw;
-    float upY = -sinPitch * cosYaw;
-    float upZ = cosPitch;
+void RendererGL::setDoorProgress(const float* progress, size_t count) {
+    m_recording->doorProgress.assign(progress, progress + count);
+}
 
-    float view[16] = {
-        rightX, upX, -forwardX, 0,
-        rightY, upY, -forwardY, 0,
-        rightZ, upZ, -forwardZ, 0,
-        0,      0,    0,        1
+void RendererGL::drawMesh3D(const Mesh3D& mesh, const Camera3D& cam, const std::vector<int>* sectorOrder) {
+    float* clear = m_recording->clearColor;
+    clear[0] = 0.02f;
+    clear[1] = 0.02f;
+    clear[2] = 0.05f;
+    clear[3] = 1.0f;
+
+    if (m_meshSource != &mesh || m_meshSourceRevision != mesh.revision || !m_meshSnapshot) {
+        // Snapshot on rebuild only, so the GL side never reads a mesh the editor is mutating.
+        m_meshSnapshot = std::make_shared<const Mesh3D>(mesh);
+        m_meshSource = &mesh;
+        m_meshSourceRevision = mesh.revision;
+        ++m_meshSerial;
+    }
+    m_recording->mesh = m_meshSnapshot;
+    m_recording->meshSerial = m_meshSerial;
+
+    const uint32_t matrix = frameMatrix(cam);
+    auto drawRange = [&](size_t start, size_t count, GLuint tex, float depth) {
+        if (count == 0 || tex == 0)
+            return;
+        RenderCommand cmd;
+        cmd.key = makeKey(resolveLayer(RenderLayer::World), RenderPass::Opaque, 1, tex, depth);
+        cmd.program = 1;
+        cmd.flags = CmdDepthTest | CmdMesh;
+        cmd.primitive = GL_TRIANGLES;
+        cmd.texture = tex;
+        cmd.matrix = matrix;
+        cmd.first = static_cast<uint32_t>(start);
+        cmd.count = static_cast<uint32_t>(count);
+        m_recording->commands.push_back(cmd);
     };
 
-    view[12] = -(cam.x * rightX + cam.y * rightY + cam.z * rightZ);
-    view[13] = -(cam.x * upX + cam.y * upY + cam.z * upZ);
-    view[14] =  (cam.x * forwardX + cam.y * forwardY + cam.z * forwardZ);
+    drawRange(mesh.doorIndexStart, mesh.doorIndexCount, m_texDoor, 0.0f);
 
-    float mvp[16];
-    for (int c = 0; c < 4; ++c) {
-        for (int r = 0; r < 4; ++r) {
-            mvp[c * 4 + r] =
-                proj[0 * 4 + r] * view[c * 4 + 0] +
-                proj[1 * 4 + r] * view[c * 4 + 1] +
-                proj[2 * 4 + r] * view[c * 4 + 2] +
-                proj[3 * 4 + r] * view[c * 4 + 3];
-        }
+    const size_t chunkCount = mesh.chunks.size();
+    if (chunkCount == 0) {
+        drawRange(mesh.floorIndexStart, mesh.floorIndexCount, m_texFloor, 0.0f);
+        drawRange(mesh.ceilingIndexStart, mesh.ceilingIndexCount, m_texCeil, 0.0f);
+        drawRange(mesh.wallIndexStart, mesh.wallIndexCount, m_texWall, 0.0f);
+        return;
     }
 
-    glUseProgram(m_program3D);
-    glUniformMatrix4fv(m_uniformMVP, 1, GL_FALSE, mvp);
-    glUniform1i(m_uniformTex, 0);
-    glActiveTexture(GL_TEXTURE0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DPos);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * mesh.vertices.size(), mesh.vertices.data(), GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(m_attrPos3D);
-    glVertexAttribPointer(m_attrPos3D, 3, GL_FLOAT, GL_FALSE, 0, (const void*)0);
+    Frustum frustum;
+    buildFrustum(&m_recording->matrices[matrix * 16], frustum);
+    m_chunkVisible.resize(chunkCount);
+    const size_t visibleCount = cullBoxes(frustum,
+                                          mesh.chunkMinX.data(), mesh.chunkMinY.data(), mesh.chunkMinZ.data(),
+                                          mesh.chunkMaxX.data(), mesh.chunkMaxY.data(), mesh.chunkMaxZ.data(),
+                                          chunkCount, m_chunkVisible.data());
+    m_cullStats.chunksTotal += chunkCount;
+
+    // Emits the visible chunks in [begin, end) per material, merging index-contiguous runs.
+    auto drawChunks = [&](size_t begin, size_t end, uint32_t MeshChunk::*startField,
+                          uint32_t MeshChunk::*countField, GLuint tex, float depth) {
+        size_t runStart = 0;
+        size_t runCount = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const MeshChunk& chunk = mesh.chunks[i];
+            const size_t count = chunk.*countField;
+            if (!m_chunkVisible[i] || count == 0)
+                continue;
+            const size_t start = chunk.*startField;
+            if (runCount > 0 && runStart + runCount == start) {
+                runCount += count;
+                continue;
+            }
+            drawRange(runStart, runCount, tex, depth);
+            runStart = start;
+            runCount = count;
+        }
+        drawRange(runStart, runCount, tex, depth);
+    };
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DUV);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * mesh.uvs.size(), mesh.uvs.data(), GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(m_attrUV3D);
-    glVertexAttribPointer(m_attrUV3D, 2, GL_FLOAT, GL_FALSE, 0, (const void*)0);
+    if (!sectorOrder || mesh.sectorChunkStart.empty()) {
+        m_cullStats.chunksVisible += visibleCount;
+        drawChunks(0, chunkCount, &MeshChunk::floorStart, &MeshChunk::floorCount, m_texFloor, 0.0f);
+        drawChunks(0, chunkCount, &MeshChunk::ceilingStart, &MeshChunk::ceilingCount, m_texCeil, 0.0f);
+        drawChunks(0, chunkCount, &MeshChunk::wallStart, &MeshChunk::wallCount, m_texWall, 0.0f);
+        return;
+    }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo3D);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * mesh.indices.size(), mesh.indices.data(), GL_DYNAMIC_DRAW);
+    // Sector order is front to back; feeding the rank in as depth makes the opaque sort draw
+    // near sectors first within each texture, so far ones fail the depth test early.
+    const size_t sectorCount = mesh.sectorChunkStart.size() - 1;
+    const float rankScale = sectorOrder->empty() ? 0.0f : 511.0f / static_cast<float>(sectorOrder->size());
+    for (size_t rank = 0; rank < sectorOrder->size(); ++rank) {
+        const int sector = (*sectorOrder)[rank];
+        if (sector < 0 || static_cast<size_t>(sector) >= sectorCount)
+            continue;
+        const size_t begin = mesh.sectorChunkStart[sector];
+        const size_t end = mesh.sectorChunkStart[sector + 1];
+        for (size_t i = begin; i < end; ++i)
+            m_cullStats.chunksVisible += m_chunkVisible[i];
+        const float depth = static_cast<float>(rank) * rankScale;
+        drawChunks(begin, end, &MeshChunk::floorStart, &MeshChunk::floorCount, m_texFloor, depth);
+        drawChunks(begin, end, &MeshChunk::ceilingStart, &MeshChunk::ceilingCount, m_texCeil, depth);
+        drawChunks(begin, end, &MeshChunk::wallStart, &MeshChunk::wallCount, m_texWall, depth);
+    }
+}
 
-    auto drawRange = [&](size_t start, size_t count, GLuint tex) {
-        if (count == 0 || tex == 0)
-            return;
-        glBindTexture(GL_TEXTURE_2D, tex);
-        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(count), GL_UNSIGNED_SHORT, (const void*)(start * sizeof(uint16_t)));
-    };
+void RendererGL::queueSprite(float x, float y, float z, float size, GLuint tex, float r, float g, float b) {
+    // A camera-facing quad of side `size` fits in a sphere of radius size/sqrt(2).
+    m_sprites.x.push_back(x);
+    m_sprites.y.push_back(y);
+    m_sprites.z.push_back(z);
+    m_sprites.radius.push_back(size * 0.70710678f);
+    m_sprites.size.push_back(size);
+    m_sprites.tex.push_back(tex);
+    m_sprites.r.push_back(r);
+    m_sprites.g.push_back(g);
+    m_sprites.b.push_back(b);
+}
 
-    drawRange(mesh.floorIndexStart, mesh.floorIndexCount, m_texFloor);
-    drawRange(mesh.ceilingIndexStart, mesh.ceilingIndexCount, m_texCeil);
-    drawRange(mesh.wallIndexStart, mesh.wallIndexCount, m_texWall);
+void RendererGL::drawSprites(const Camera3D& cam) {
+    const size_t count = m_sprites.x.size();
+    if (count > 0) {
+        Frustum frustum;
+        buildFrustum(&m_recording->matrices[frameMatrix(cam) * 16], frustum);
+        m_sprites.visible.resize(count);
+        const size_t visibleCount = cullSpheres(frustum, m_sprites.x.data(), m_sprites.y.data(),
+                                                m_sprites.z.data(), m_sprites.radius.data(),
+                                                count, m_sprites.visible.data());
+        m_cullStats.spritesVisible += visibleCount;
+        m_cullStats.spritesTotal += count;
+        for (size_t i = 0; i < count; ++i) {
+            if (m_sprites.visible[i]) {
+                drawBillboard3D(cam, m_sprites.x[i], m_sprites.y[i], m_sprites.z[i], m_sprites.size[i],
+                                m_sprites.tex[i], m_sprites.r[i], m_sprites.g[i], m_sprites.b[i]);
+            }
+        }
+    }
 
-    glDisableVertexAttribArray(m_attrPos3D);
-    glDisableVertexAttribArray(m_attrUV3D);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    m_sprites.x.clear();
+    m_sprites.y.clear();
+    m_sprites.z.clear();
+    m_sprites.radius.clear();
+    m_sprites.size.clear();
+    m_sprites.tex.clear();
+    m_sprites.r.clear();
+    m_sprites.g.clear();
+    m_sprites.b.clear();
 }
 
 void RendererGL::drawGrid(const Camera2D& cam, float gridSize) {
@@ -732,10 +916,11 @@ void RendererGL::setCamera(const Camera2D& cam) {
         m_camera.zoom = 0.0001f;
 }
 
-void RendererGL::setTextures(GLuint floorTex, GLuint wallTex, GLuint ceilTex) {
+void RendererGL::setTextures(GLuint floorTex, GLuint wallTex, GLuint ceilTex, GLuint doorTex) {
     m_texFloor = floorTex;
     m_texWall = wallTex;
     m_texCeil = ceilTex;
+    m_texDoor = doorTex;
 }
 
 void RendererGL::setBillboardTextures(GLuint enemyTex, GLuint projectileTex) {
@@ -809,10 +994,449 @@ bool RendererGL::projectPoint3D(const Camera3D& cam, float x, float y, float z,
     return true;
 }
 
+void RendererGL::beginRecording(RenderPacket* packet) {
+    m_lastStats = packet->stats;
+    packet->commands.clear();
+    packet->verts.clear();
+    packet->matrices.clear();
+    packet->mesh.reset();
+    packet->doorProgress.clear();
+    std::fill(std::begin(packet->moverOffsets), std::end(packet->moverOffsets), 0.0f);
+    packet->capture = false;
+    packet->replayIterations = 0;
+    packet->inputSampledNs = 0;
+    m_recording = packet;
+    m_layer = RenderLayer::Auto;
+}
+
 void RendererGL::endFrame(SDL_Window* window) {
+    RenderPacket* packet = m_recording;
+    packet->width = m_width;
+    packet->height = m_height;
+    packet->capture = m_captureNextFrame;
+    packet->replayIterations = m_pendingReplay;
+    m_captureNextFrame = false;
+    m_pendingReplay = 0;
+    packet->inputSampledNs = m_inputSampledNs;
+    m_inputSampledNs = 0;
+    m_lastCullStats = m_cullStats;
+    m_cullStats = RenderCullStats{};
+
+#ifdef MAPMAKER_RENDER_THREAD
+    if (m_threaded) {
+        // Publish this frame, then take back a packet the render thread has finished with.
+        // Blocking here is what paces the main thread to the render thread's vsync. The ready
+        // queue has room for every packet, so the push itself never fails.
+        m_readyQueue.push(packet);
+        wakeRenderThread();
+        RenderPacket* next = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_mainWake.wait(lock, [&] { return m_freeQueue.pop(next); });
+        }
+        beginRecording(next);
+        return;
+    }
+#endif
+
+    executePacket(*packet);
     SDL_GL_SwapWindow(window);
+    notePresented(*packet);
+    beginRecording(packet);
+}
+
+void RendererGL::notePresented(RenderPacket& packet) {
+    const uint64_t now = PlatformTimeNs();
+    if (packet.inputSampledNs > 0)
+        packet.stats.inputLatencyNs = now - packet.inputSampledNs;
+    m_presentedNs.store(now, std::memory_order_release);
+}
+
+void RendererGL::executePacket(RenderPacket& packet) {
+    if (packet.width != m_viewportW || packet.height != m_viewportH) {
+        glViewport(0, 0, packet.width, packet.height);
+        m_viewportW = packet.width;
+        m_viewportH = packet.height;
+    }
+
+    if (packet.mesh && packet.meshSerial != m_uploadedMeshSerial) {
+        const Mesh3D& mesh = *packet.mesh;
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DPos);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * mesh.vertices.size(), mesh.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DUV);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * mesh.uvs.size(), mesh.uvs.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DMover);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * mesh.movers.size(), mesh.movers.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo3D);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * mesh.indices.size(), mesh.indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        m_uploadedMeshSerial = packet.meshSerial;
+        m_doorUploaded.assign(mesh.doors.size(), 0.0f);
+    }
+    // A door opens by lifting the bottom edge of its slab; the top stays put and its v is pulled
+    // down so the texture slides up with it. Only that door's own vertices are sent.
+    size_t doorBytes = 0;
+    if (packet.mesh && !packet.doorProgress.empty()) {
+        const Mesh3D& mesh = *packet.mesh;
+        const size_t doorCount = std::min(packet.doorProgress.size(), mesh.doors.size());
+        for (size_t d = 0; d < doorCount; ++d) {
+            const float progress = std::min(std::max(packet.doorProgress[d], 0.0f), 1.0f);
+            const MeshDoor& door = mesh.doors[d];
+            if (progress == m_doorUploaded[d] || door.vertexCount == 0)
+                continue;
+            m_doorUploaded[d] = progress;
+            const float height = door.top - door.bottom;
+            const float rise = progress * height;
+            const float* restPos = &mesh.vertices[door.firstVertex * 3];
+            const float* restUV = &mesh.uvs[door.firstVertex * 2];
+            m_doorPos.assign(restPos, restPos + door.vertexCount * 3);
+            m_doorUV.assign(restUV, restUV + door.vertexCount * 2);
+            for (uint32_t v = 0; v < door.vertexCount; ++v) {
+                if (m_doorPos[v * 3 + 2] < door.top - 0.0001f)
+                    m_doorPos[v * 3 + 2] += rise;
+                else if (height > 0.0f)
+                    m_doorUV[v * 2 + 1] -= rise / height;
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DPos);
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(sizeof(float) * 3 * door.firstVertex),
+                            static_cast<GLsizeiptr>(sizeof(float) * m_doorPos.size()), m_doorPos.data());
+            glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DUV);
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(sizeof(float) * 2 * door.firstVertex),
+                            static_cast<GLsizeiptr>(sizeof(float) * m_doorUV.size()), m_doorUV.data());
+            doorBytes += sizeof(float) * (m_doorPos.size() + m_doorUV.size());
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    // Doors and lifts move by changing these few floats; the mesh buffers above stay as uploaded.
+    glUseProgram(m_program3D);
+    glUniform1fv(m_uniformMoverOffset, kMaxSectorMovers + 1, packet.moverOffsets);
+
+    m_order.resize(packet.commands.size());
+    for (size_t i = 0; i < m_order.size(); ++i) m_order[i] = static_cast<uint32_t>(i);
+    std::sort(m_order.begin(), m_order.end(), [&](uint32_t a, uint32_t b) {
+        return packet.commands[a].key < packet.commands[b].key;
+    });
+
+    glClearColor(packet.clearColor[0], packet.clearColor[1], packet.clearColor[2], packet.clearColor[3]);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    RenderFrameStats stats;
+    executeCommands(packet.commands, m_order, packet.verts, packet.matrices, stats);
+    stats.doorBytes = doorBytes;
+    packet.stats = stats;
+
+    // Keep the frame around for replay; swapping preserves both sets of capacity.
+    m_lastCommands.swap(packet.commands);
+    m_lastVerts.swap(packet.verts);
+    m_lastMatrices.swap(packet.matrices);
+    m_lastOrder.swap(m_order);
+    std::memcpy(m_lastClearColor, packet.clearColor, sizeof(m_lastClearColor));
+
+    if (packet.capture)
+        dumpCommands(stats);
+    if (packet.replayIterations > 0)
+        replayFrame(packet.replayIterations);
+
+    m_transient.nextFrame();
+}
+
+void RendererGL::executeCommands(const std::vector<RenderCommand>& commands, const std::vector<uint32_t>& order,
+                                 const std::vector<float>& verts, const std::vector<float>& matrices,
+                                 RenderFrameStats& stats) {
+    stats.commands = commands.size();
+    if (commands.empty())
+        return;
+
+    auto floatsPerVertex = [](const RenderCommand& c) { return c.program == 0 ? 2u : 5u; };
+    auto sameState = [](const RenderCommand& a, const RenderCommand& b) {
+        return a.program == b.program && a.flags == b.flags && a.primitive == b.primitive &&
+               a.texture == b.texture && a.matrix == b.matrix &&
+               a.color[0] == b.color[0] && a.color[1] == b.color[1] &&
+               a.color[2] == b.color[2] && a.color[3] == b.color[3];
+    };
+
+    // Merge runs of identical state into batches, gathering their vertices contiguously.
+    std::vector<RenderBatch>& batches = m_batches;
+    batches.clear();
+    m_batchVerts.clear();
+    for (size_t i = 0; i < order.size(); ++i) {
+        const RenderCommand& c = commands[order[i]];
+        if (c.flags & CmdMesh) {
+            batches.push_back({ &c, c.first, c.count });
+            continue;
+        }
+        const uint32_t fpv = floatsPerVertex(c);
+        const uint32_t first = static_cast<uint32_t>(m_batchVerts.size()) / fpv;
+        if (!batches.empty() && !(batches.back().cmd->flags & CmdMesh) &&
+            sameState(*batches.back().cmd, c) && m_batchVerts.size() % fpv == 0 &&
+            batches.back().first + batches.back().count == first) {
+            batches.back().count += c.count;
+        } else {
+            // Pad so the batch starts on a whole vertex of its own format.
+            while (m_batchVerts.size() % fpv != 0) m_batchVerts.push_back(0.0f);
+            batches.push_back({ &c, static_cast<uint32_t>(m_batchVerts.size()) / fpv, c.count });
+        }
+        m_batchVerts.insert(m_batchVerts.end(), verts.begin() + c.first, verts.begin() + c.first + c.count * fpv);
+    }
+
+    size_t baseOffset = 0;
+    if (!m_batchVerts.empty()) {
+        baseOffset = m_transient.write(m_batchVerts.data(), sizeof(float) * m_batchVerts.size());
+        stats.vertexBytes = sizeof(float) * m_batchVerts.size();
+    }
+
+    int currentProgram = -1;
+    GLuint currentTexture = 0;
+    int currentFlags = -1;
+    uint32_t currentMatrix = 0xFFFFFFFFu;
+    bool meshBound = false;
+    bool streamBound = false;
+    glActiveTexture(GL_TEXTURE0);
+
+    for (const RenderBatch& batch : batches) {
+        const RenderCommand& c = *batch.cmd;
+        if (currentProgram != c.program) {
+            if (currentProgram == 0) glDisableVertexAttribArray(m_attrPos);
+            if (currentProgram == 1) {
+                glDisableVertexAttribArray(m_attrPos3D);
+                glDisableVertexAttribArray(m_attrUV3D);
+                glDisableVertexAttribArray(m_attrMover3D);
+            }
+            glUseProgram(c.program == 0 ? m_program : m_program3D);
+            if (c.program == 1) glUniform1i(m_uniformTex, 0);
+            currentProgram = c.program;
+            currentMatrix = 0xFFFFFFFFu;
+            meshBound = false;
+            streamBound = false;
+            ++stats.programChanges;
+        }
+        if (currentFlags != c.flags) {
+            if (c.flags & CmdDepthTest) glEnable(GL_DEPTH_TEST);
+            else glDisable(GL_DEPTH_TEST);
+            if (c.flags & CmdBlend) {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            } else {
+                glDisable(GL_BLEND);
+            }
+            currentFlags = c.flags;
+        }
+
+        if (c.program == 0) {
+            glUniform4f(m_uniformColor, c.color[0], c.color[1], c.color[2], c.color[3]);
+            if (!streamBound) {
+                glBindBuffer(GL_ARRAY_BUFFER, m_transient.buffer());
+                glEnableVertexAttribArray(m_attrPos);
+                streamBound = true;
+            }
+            const size_t offset = baseOffset + sizeof(float) * 2 * batch.first;
+            glVertexAttribPointer(m_attrPos, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (const void*)offset);
+            glDrawArrays(c.primitive, 0, static_cast<GLsizei>(batch.count));
+            ++stats.drawCalls;
+            continue;
+        }
+
+        if (currentMatrix != c.matrix) {
+            glUniformMatrix4fv(m_uniformMVP, 1, GL_FALSE, &matrices[c.matrix * 16]);
+            currentMatrix = c.matrix;
+        }
+        if (currentTexture != c.texture) {
+            glBindTexture(GL_TEXTURE_2D, c.texture);
+            currentTexture = c.texture;
+            ++stats.textureChanges;
+        }
+        if (c.flags & CmdMesh) {
+            if (!meshBound) {
+                glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DPos);
+                glEnableVertexAttribArray(m_attrPos3D);
+                glVertexAttribPointer(m_attrPos3D, 3, GL_FLOAT, GL_FALSE, 0, (const void*)0);
+                glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DUV);
+                glEnableVertexAttribArray(m_attrUV3D);
+                glVertexAttribPointer(m_attrUV3D, 2, GL_FLOAT, GL_FALSE, 0, (const void*)0);
+                glBindBuffer(GL_ARRAY_BUFFER, m_vbo3DMover);
+                glEnableVertexAttribArray(m_attrMover3D);
+                glVertexAttribPointer(m_attrMover3D, 4, GL_FLOAT, GL_FALSE, 0, (const void*)0);
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo3D);
+                meshBound = true;
+                streamBound = false;
+            }
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(batch.count), GL_UNSIGNED_SHORT,
+                           (const void*)(batch.first * sizeof(uint16_t)));
+        } else {
+            const GLsizei stride = sizeof(float) * 5;
+            const size_t offset = baseOffset + sizeof(float) * 5 * batch.first;
+            glBindBuffer(GL_ARRAY_BUFFER, m_transient.buffer());
+            glEnableVertexAttribArray(m_attrPos3D);
+            glVertexAttribPointer(m_attrPos3D, 3, GL_FLOAT, GL_FALSE, stride, (const void*)offset);
+            glEnableVertexAttribArray(m_attrUV3D);
+            glVertexAttribPointer(m_attrUV3D, 2, GL_FLOAT, GL_FALSE, stride, (const void*)(offset + sizeof(float) * 3));
+            // Streamed quads take a constant mover attribute: slot 0, unclamped.
+            glDisableVertexAttribArray(m_attrMover3D);
+            glVertexAttrib4f(m_attrMover3D, 0.0f, 0.0f, -kMoverNoClamp, kMoverNoClamp);
+            glDrawArrays(c.primitive, 0, static_cast<GLsizei>(batch.count));
+            meshBound = false;
+        }
+        ++stats.drawCalls;
+    }
+
+    if (currentProgram == 0) glDisableVertexAttribArray(m_attrPos);
+    if (currentProgram == 1) {
+        glDisableVertexAttribArray(m_attrPos3D);
+        glDisableVertexAttribArray(m_attrUV3D);
+        glDisableVertexAttribArray(m_attrMover3D);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+}
+
+void RendererGL::dumpCommands(const RenderFrameStats& stats) const {
+    static const char* layerNames[] = { "world", "grid", "fills", "lines", "points", "overlay", "hud" };
+    std::printf("frame: %zu commands -> %zu draws (%zu program, %zu texture changes, %zu vertex bytes, "
+                "%zu door bytes)\n",
+                stats.commands, stats.drawCalls, stats.programChanges,
+                stats.textureChanges, stats.vertexBytes, stats.doorBytes);
+    for (uint32_t idx : m_lastOrder) {
+        const RenderCommand& c = m_lastCommands[idx];
+        unsigned layer = static_cast<unsigned>(c.key >> 60);
+        unsigned pass = static_cast<unsigned>((c.key >> 58) & 0x3);
+        std::printf("  %016llx %-7s %s prog=%u tex=%u prim=%u %s%u color=(%.2f %.2f %.2f %.2f)\n",
+                    static_cast<unsigned long long>(c.key),
+                    layer < 7 ? layerNames[layer] : "?",
+                    pass == 0 ? "opaque" : "blend ",
+                    c.program, c.texture, c.primitive,
+                    (c.flags & CmdMesh) ? "indices=" : "verts=", c.count,
+                    c.color[0], c.color[1], c.color[2], c.color[3]);
+    }
+}
+
+void RendererGL::replayFrame(int iterations) {
+    if (m_lastCommands.empty() || iterations <= 0)
+        return;
+    glFinish();
+    uint64_t start = PlatformTicks();
+    RenderFrameStats stats;
+    for (int i = 0; i < iterations; ++i) {
+        m_transient.nextFrame();
+        glClearColor(m_lastClearColor[0], m_lastClearColor[1], m_lastClearColor[2], m_lastClearColor[3]);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        executeCommands(m_lastCommands, m_lastOrder, m_lastVerts, m_lastMatrices, stats);
+    }
+    glFinish();
+    uint64_t elapsed = PlatformTicks() - start;
+    std::printf("replayed last frame x%d: %.3f ms/frame (%zu commands, %zu draws)\n",
+                iterations, static_cast<double>(elapsed) / iterations, stats.commands, stats.drawCalls);
+}
+
+bool RendererGL::startRenderThread(SDL_Window* window, SDL_GLContext context) {
+#ifdef MAPMAKER_RENDER_THREAD
+    if (m_threaded || !window || !context)
+        return m_threaded;
+    // The context can only be current on one thread; release it here for the render thread.
+    if (SDL_GL_MakeCurrent(window, nullptr) != 0) {
+        std::printf("Render thread disabled: could not release GL context (%s)\n", SDL_GetError());
+        return false;
+    }
+    for (int i = 0; i < kFramesInFlight; ++i) {
+        if (&m_packets[i] != m_recording)
+            m_freeQueue.push(&m_packets[i]);
+    }
+    m_threadWindow = window;
+    m_threadContext = context;
+    m_threadStop.store(false);
+    m_threadStartup = ThreadStartup::Pending;
+    m_thread = std::thread(&RendererGL::renderThreadMain, this);
+    // Wait for the thread to take the context; if it can't, take it back and render inline.
+    bool running = false;
+    {
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_mainWake.wait(lock, [&] { return m_threadStartup != ThreadStartup::Pending; });
+        running = m_threadStartup == ThreadStartup::Running;
+    }
+    if (!running) {
+        m_thread.join();
+        RenderPacket* packet = nullptr;
+        while (m_freeQueue.pop(packet)) {}
+        SDL_GL_MakeCurrent(window, context);
+        std::printf("Render thread disabled: rendering on the main thread\n");
+        return false;
+    }
+    m_threaded = true;
+    std::printf("Render thread started\n");
+    return true;
+#else
+    (void)window;
+    (void)context;
+    return false;
+#endif
+}
+
+void RendererGL::stopRenderThread() {
+#ifdef MAPMAKER_RENDER_THREAD
+    if (!m_threaded)
+        return;
+    m_threadStop.store(true);
+    wakeRenderThread();
+    m_thread.join();
+    m_threaded = false;
+    RenderPacket* packet = nullptr;
+    while (m_readyQueue.pop(packet)) {}
+    while (m_freeQueue.pop(packet)) {}
+    SDL_GL_MakeCurrent(m_threadWindow, m_threadContext);
+#endif
+}
+
+bool RendererGL::renderThreadActive() const {
+#ifdef MAPMAKER_RENDER_THREAD
+    return m_threaded;
+#else
+    return false;
+#endif
+}
+
+#ifdef MAPMAKER_RENDER_THREAD
+void RendererGL::wakeRenderThread() {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_renderWake.notify_one();
 }
 
+void RendererGL::wakeMainThread() {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_mainWake.notify_one();
+}
+
+void RendererGL::renderThreadMain() {
+    const bool current = SDL_GL_MakeCurrent(m_threadWindow, m_threadContext) == 0;
+    if (!current)
+        std::printf("Render thread: SDL_GL_MakeCurrent failed: %s\n", SDL_GetError());
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_threadStartup = current ? ThreadStartup::Running : ThreadStartup::Failed;
+        m_mainWake.notify_one();
+    }
+    if (!current)
+        return;
+    while (true) {
+        RenderPacket* packet = nullptr;
+        {
+            // Stop is only honoured once the ready queue is drained.
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_renderWake.wait(lock, [&] { return m_readyQueue.pop(packet) || m_threadStop.load(); });
+        }
+        if (!packet)
+            break;
+        executePacket(*packet);
+        SDL_GL_SwapWindow(m_threadWindow);
+        notePresented(*packet);
+        m_freeQueue.push(packet);
+        wakeMainThread();
+    }
+    SDL_GL_MakeCurrent(m_threadWindow, nullptr);
+}
+#endif
+
 // ===== internal helpers =====
 
 bool RendererGL::initGL() {
@@ -846,14 +1470,20 @@ bool RendererGL::initGL() {
         return false;
     }
 
+    // aMover is (slot, wall v per unit z, min z, max z). The slot picks a height offset (slot 0 is
+    // always 0); the clamp keeps wall pieces from inverting and v follows z so textures stay put.
+    static_assert(kMaxSectorMovers == 16, "uMoverOffset below is sized for kMaxSectorMovers + 1");
     const char* vsSrc3D =
         "uniform mat4 uMVP;\n"
+        "uniform float uMoverOffset[17];\n"
         "attribute vec3 aPos;\n"
         "attribute vec2 aUV;\n"
+        "attribute vec4 aMover;\n"
         "varying vec2 vUV;\n"
         "void main() {\n"
-        "    vUV = aUV;\n"
-        "    gl_Position = uMVP * vec4(aPos, 1.0);\n"
+        "    float z = clamp(aPos.z + uMoverOffset[int(aMover.x + 0.5)], aMover.z, aMover.w);\n"
+        "    vUV = vec2(aUV.x, aUV.y + (z - aPos.z) * aMover.y);\n"
+        "    gl_Position = uMVP * vec4(aPos.xy, z, 1.0);\n"
         "}\n";
 
     const char* fsSrc3D =
@@ -873,10 +1503,13 @@ bool RendererGL::initGL() {
 
     m_attrPos3D   = glGetAttribLocation(m_program3D, "aPos");
     m_attrUV3D    = glGetAttribLocation(m_program3D, "aUV");
+    m_attrMover3D = glGetAttribLocation(m_program3D, "aMover");
     m_uniformMVP  = glGetUniformLocation(m_program3D, "uMVP");
     m_uniformTex  = glGetUniformLocation(m_program3D, "uTex");
+    m_uniformMoverOffset = glGetUniformLocation(m_program3D, "uMoverOffset");
 
-    if (m_attrPos3D < 0 || m_attrUV3D < 0 || m_uniformMVP < 0 || m_uniformTex < 0) {
+    if (m_attrPos3D < 0 || m_attrUV3D < 0 || m_attrMover3D < 0 || m_uniformMVP < 0 || m_uniformTex < 0 ||
+        m_uniformMoverOffset < 0) {
         std::printf("Failed to get 3D shader locations\n");
         return false;
     }
@@ -942,24 +1575,15 @@ void RendererGL::drawQuad2D(float x, float y, float w, float h, float r, float g
     float x1 = ((x + w) / (static_cast<float>(screenW) * 0.5f)) - 1.0f;
     float y1 = 1.0f - ((y + h) / (static_cast<float>(screenH) * 0.5f));
 
-    const float verts[8] = {
+    const float verts[12] = {
         x0, y0,
         x1, y0,
         x1, y1,
+        x0, y0,
+        x1, y1,
         x0, y1
     };
-
-    glDisable(GL_DEPTH_TEST);
-    glUseProgram(m_program);
-    glUniform4f(m_uniformColor, r, g, b, a);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(m_attrPos);
-    glVertexAttribPointer(m_attrPos, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (const void*)0);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-    glDisableVertexAttribArray(m_attrPos);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    record2D(RenderLayer::HUD, GL_TRIANGLES, verts, 12, r, g, b, a, 0);
 }
 
 void RendererGL::drawText2D(const std::string& text, float x, float y, float scale, float r, float g, float b, float a, int screenW, int screenH) {
@@ -988,6 +1612,8 @@ static const char* hudEntityName(EntityType t) {
         case EntityType::PlayerStart: return "PlayerStart";
         case EntityType::EnemyWizard: return "EnemyWizard";
         case EntityType::ItemPickup:  return "ItemPickup";
+        case EntityType::Door:        return "Door";
+        case EntityType::Spawner:     return "Spawner";
     }
     return "Unknown";
 }
@@ -1003,6 +1629,8 @@ void RendererGL::drawEditorHUD(const EditorState& state, int screenW, int screen
                 case EntityType::PlayerStart: r = 0.1f; g = 0.8f; b = 0.1f; return;
                 case EntityType::EnemyWizard: r = 0.7f; g = 0.2f; b = 0.9f; return;
                 case EntityType::ItemPickup:  r = 1.0f; g = 0.5f; b = 0.1f; return;
+                case EntityType::Door:        r = 0.6f; g = 0.6f; b = 0.0f; return;
+                case EntityType::Spawner:     r = 0.9f; g = 0.1f; b = 0.3f; return;
             }
         }
         if (state.wallMode) { r = 1.0f; g = 0.9f; b = 0.2f; return; }
@@ -1055,6 +1683,16 @@ void RendererGL::drawEditorHUD(const EditorState& state, int screenW, int screen
     } else if (state.entityMode) {
         controls1 = "Entity (" + std::string(hudEntityName(state.entityBrush)) + "): A place  |  X delete  |  D-Pad Up cycle  |  D-Pad Down exit";
         controls2 = "Left Stick move cursor  |  Right Stick pan view  |  L/R zoom  |  Minus playtest";
+        if (state.selectedEntity >= 0 && state.selectedEntity < static_cast<int>(state.entities.size()) &&
+            state.entities[state.selectedEntity].type == EntityType::Spawner) {
+            const Entity& spawner = state.entities[state.selectedEntity];
+            char spawnerBuf[128];
+            std::snprintf(spawnerBuf, sizeof(spawnerBuf),
+                          "Spawner: %u per wave (D-Pad L/R), cap %u (Shift+PgUp/PgDn), every %.1f s ([ ])",
+                          static_cast<unsigned>(spawner.waveSize), static_cast<unsigned>(spawner.waveCap),
+                          spawner.waveInterval);
+            controls2 = spawnerBuf;
+        }
     } else if (state.wallMode) {
         controls1 = "Walls: B select/extend  |  A place vertex  |  X delete";
         controls2 = "Left Stick move cursor  |  Right Stick pan view  |  L/R zoom  |  D-Pad Up entity mode  |  Minus playtest";
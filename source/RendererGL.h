@@ -22,13 +22,28 @@
 #include <SDL_opengl.h>
 #endif
 #endif
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
+#include "Mesh3D.h"
+#include "SpscQueue.h"
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__) && !defined(__SWITCH__)
+#define MAPMAKER_RENDER_THREAD 1
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 
 struct Sector;
 struct EditorState;
 struct Camera3D;
-struct Mesh3D;
 GLuint loadTextureFromPNG(const char* path);
+// Decodes the files in parallel on the job system, then uploads them in order.
+void loadTexturesFromPNG(const char* const* paths, size_t count, GLuint* outTextures);
 
 struct Camera2D {
     float zoom = 1.0f;
@@ -36,24 +51,150 @@ struct Camera2D {
     float offsetY = 0.0f;
 };
 
+// Per-frame streaming storage for immediate-style geometry. A few large buffers are
+// cycled round-robin so a buffer is only rewritten once the GPU has moved past it;
+// draws sub-allocate by offset instead of re-specifying the buffer.
+class TransientVertexBuffer {
+public:
+    static constexpr int kBufferCount = 3;
+
+    bool init(size_t capacityBytes);
+    void destroy();
+    void nextFrame();
+    // Uploads data and returns its byte offset in buffer(); leaves buffer() bound to GL_ARRAY_BUFFER.
+    size_t write(const void* data, size_t bytes);
+    GLuint buffer() const { return m_buffers[m_index]; }
+    size_t reallocations() const { return m_reallocations; }
+
+private:
+    void grow(size_t minBytes);
+
+    GLuint m_buffers[kBufferCount] = {};
+    size_t m_capacity[kBufferCount] = {};
+    int m_index = 0;
+    size_t m_offset = 0;
+    size_t m_reallocations = 0;
+};
+
+// Coarse draw ordering for the recorded command list; lower layers are drawn first.
+// Auto picks the layer from the kind of draw (grid, fill, line, point, HUD).
+enum class RenderLayer : uint8_t {
+    World = 0,
+    Grid,
+    Fills,
+    Lines,
+    Points,
+    Overlay,
+    HUD,
+    Auto = 15
+};
+
+enum class RenderPass : uint8_t {
+    Opaque = 0,
+    Translucent
+};
+
+struct RenderCommand {
+    uint64_t key = 0;
+    uint8_t program = 0;   // 0 = flat 2D, 1 = textured 3D
+    uint8_t flags = 0;     // RendererGL::Cmd* bits
+    GLenum primitive = GL_TRIANGLES;
+    GLuint texture = 0;
+    float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    uint32_t matrix = 0;   // index into the frame's 3D matrices
+    uint32_t first = 0;    // float offset into the frame vertex stream, or index start for mesh draws
+    uint32_t count = 0;    // vertices, or indices for mesh draws
+};
+
+struct RenderFrameStats {
+    size_t commands = 0;
+    size_t drawCalls = 0;
+    size_t programChanges = 0;
+    size_t textureChanges = 0;
+    size_t vertexBytes = 0;
+    size_t doorBytes = 0; // door slab vertices patched this frame
+    // Input sample to swap return; 0 when the frame was not marked.
+    uint64_t inputLatencyNs = 0;
+};
+
+// Recording-side visibility counts for the last finished frame.
+struct RenderCullStats {
+    size_t chunksVisible = 0;
+    size_t chunksTotal = 0;
+    size_t spritesVisible = 0;
+    size_t spritesTotal = 0;
+};
+
+// Everything the GL side needs to draw one frame. Recorded on the main thread and
+// executed either inline or on the render thread; no GL calls happen while recording.
+struct RenderPacket {
+    std::vector<RenderCommand> commands;
+    std::vector<float> verts;
+    std::vector<float> matrices;
+    float clearColor[4] = {0.05f, 0.05f, 0.1f, 1.0f};
+    int width = 0;
+    int height = 0;
+    // Immutable copy of the world mesh, replaced only when the mesh is rebuilt.
+    std::shared_ptr<const Mesh3D> mesh;
+    uint64_t meshSerial = 0;
+    // Height offset per mover slot; slot 0 is the static geometry and stays 0.
+    float moverOffsets[kMaxSectorMovers + 1] = {};
+    // Opening fraction per Mesh3D door; empty leaves the doors as last drawn.
+    std::vector<float> doorProgress;
+    bool capture = false;
+    int replayIterations = 0;
+    uint64_t inputSampledNs = 0;
+    RenderFrameStats stats; // filled in by the GL side after execution
+};
+
 class RendererGL {
 public:
     RendererGL();
     ~RendererGL();
 
     bool init(SDL_Window* window);
+    // Hands the GL context to a dedicated render thread; endFrame then only publishes packets.
+    // Returns false (and stays single-threaded) where threads are unavailable.
+    bool startRenderThread(SDL_Window* window, SDL_GLContext context);
+    void stopRenderThread();
+    bool renderThreadActive() const;
     void resize(int width, int height);
     void beginFrame();
     void drawLine2D(float x1, float y1, float x2, float y2, float r, float g, float b);
     void drawPoint2D(float x, float y, float size, float r, float g, float b);
     void drawSectorFill(const Sector& sector, const EditorState& state,
                         float r, float g, float b, float a);
-    void drawMesh3D(const Mesh3D& mesh, const Camera3D& cam);
+    // sectorOrder, when given, lists the sectors to draw front to back; the rest are skipped.
+    void drawMesh3D(const Mesh3D& mesh, const Camera3D& cam, const std::vector<int>* sectorOrder = nullptr);
+    // Offsets for Level movers 0..count-1 this frame; the mesh itself is not touched. Reset every frame.
+    void setMoverOffsets(const float* offsets, size_t count);
+    // Opening fraction (0 shut, 1 open) for Mesh3D doors 0..count-1. Only doors whose value
+    // changed since the last frame are re-uploaded, and only their own vertices.
+    void setDoorProgress(const float* progress, size_t count);
     void drawBillboard3D(const Camera3D& cam, float x, float y, float z, float size, GLuint tex, float r, float g, float b);
+    // Sprites are queued into SoA arrays and frustum-culled together in drawSprites.
+    void queueSprite(float x, float y, float z, float size, GLuint tex, float r, float g, float b);
+    void drawSprites(const Camera3D& cam);
     void drawGrid(const Camera2D& cam, float gridSize);
+    // Column-major view-projection matrix used for 3D draws with this camera.
+    void viewProjection(const Camera3D& cam, float out[16]) const;
     void endFrame(SDL_Window* window);
 
-    void setTextures(GLuint floorTex, GLuint wallTex, GLuint ceilTex);
+    // Draws recorded after this use the given layer instead of their default one.
+    void setLayer(RenderLayer layer) { m_layer = layer; }
+    // Prints the sorted command list of the next flushed frame.
+    void captureNextFrame() { m_captureNextFrame = true; }
+    // Re-executes the last flushed frame without swapping and reports the GPU time.
+    void replayLastFrame(int iterations) { m_pendingReplay = iterations; }
+    // Timestamp (PlatformTimeNs) of the input this frame shows; its swap reports the latency.
+    void markInputSampled(uint64_t ns) { m_inputSampledNs = ns; }
+    // PlatformTimeNs just after the latest swap returned, on whichever thread swapped. With
+    // the render thread this trails endFrame, which returns as soon as the packet is queued.
+    uint64_t lastPresentNs() const { return m_presentedNs.load(std::memory_order_acquire); }
+    const RenderFrameStats& lastFrameStats() const { return m_lastStats; }
+    const RenderCullStats& lastCullStats() const { return m_lastCullStats; }
+
+    void setTextures(GLuint floorTex, GLuint wallTex, GLuint ceilTex, GLuint doorTex);
     void setBillboardTextures(GLuint enemyTex, GLuint projectileTex);
     void setItemTextures(GLuint healthTex, GLuint manaTex);
     void setEffectTextures(GLuint blockFlashTex);
@@ -65,8 +206,38 @@ public:
     void drawEditorHUD(const EditorState& state, int screenW, int screenH);
 
 private:
+    enum : uint8_t {
+        CmdDepthTest = 1 << 0,
+        CmdBlend     = 1 << 1,
+        CmdMesh      = 1 << 2, // indexed draw from the resident world mesh buffers
+    };
+
+    struct RenderBatch {
+        const RenderCommand* cmd;
+        uint32_t first;
+        uint32_t count;
+    };
+
     bool initGL();
 
+    uint64_t makeKey(RenderLayer layer, RenderPass pass, uint8_t program, GLuint texture, float depth);
+    RenderLayer resolveLayer(RenderLayer fallback) const { return m_layer == RenderLayer::Auto ? fallback : m_layer; }
+    void record2D(RenderLayer layer, GLenum primitive, const float* verts, size_t floatCount,
+                  float r, float g, float b, float a, uint8_t flags);
+    uint32_t frameMatrix(const Camera3D& cam);
+    void beginRecording(RenderPacket* packet);
+    // GL side: runs on whichever thread owns the context.
+    void executePacket(RenderPacket& packet);
+    void notePresented(RenderPacket& packet);
+    void executeCommands(const std::vector<RenderCommand>& commands, const std::vector<uint32_t>& order,
+                         const std::vector<float>& verts, const std::vector<float>& matrices,
+                         RenderFrameStats& stats);
+    void replayFrame(int iterations);
+    void dumpCommands(const RenderFrameStats& stats) const;
+#ifdef MAPMAKER_RENDER_THREAD
+    void renderThreadMain();
+#endif
+
     GLuint compileShader(GLenum type, const char* src);
     GLuint createProgram(const char* vsSrc, const char* fsSrc);
 
@@ -87,17 +258,86 @@ private:
     GLuint m_program3D;
     GLint  m_attrPos3D;
     GLint  m_attrUV3D;
+    GLint  m_attrMover3D;
     GLint  m_uniformMVP;
+    GLint  m_uniformMoverOffset;
     GLint  m_uniformTex;
 
-    GLuint m_vbo;
+    TransientVertexBuffer m_transient;
+
+    // World mesh lives in static buffers and is only re-uploaded when a new snapshot arrives.
     GLuint m_vbo3DPos;
     GLuint m_vbo3DUV;
+    GLuint m_vbo3DMover;
     GLuint m_ibo3D;
+    uint64_t m_uploadedMeshSerial = 0;
+    // Door progress as currently in m_vbo3DPos/m_vbo3DUV, plus scratch for patching one door.
+    std::vector<float> m_doorUploaded;
+    std::vector<float> m_doorPos;
+    std::vector<float> m_doorUV;
+
+    // Recording state (main thread). Packet vectors keep their capacity between frames,
+    // so steady state does not allocate.
+    static constexpr int kFramesInFlight = 2;
+    RenderPacket m_packets[kFramesInFlight];
+    RenderPacket* m_recording = nullptr;
+    const Mesh3D* m_meshSource = nullptr;
+    uint32_t m_meshSourceRevision = 0;
+    std::shared_ptr<const Mesh3D> m_meshSnapshot;
+    uint64_t m_meshSerial = 0;
+    RenderLayer m_layer = RenderLayer::Auto;
+    bool m_captureNextFrame = false;
+    int m_pendingReplay = 0;
+    uint64_t m_inputSampledNs = 0;
+    std::atomic<uint64_t> m_presentedNs{0};
+    RenderFrameStats m_lastStats;
+    RenderCullStats m_cullStats;
+    RenderCullStats m_lastCullStats;
+    std::vector<uint8_t> m_chunkVisible;
+    struct SpriteQueue {
+        std::vector<float> x, y, z, radius, size;
+        std::vector<float> r, g, b;
+        std::vector<GLuint> tex;
+        std::vector<uint8_t> visible;
+    } m_sprites;
+
+    // Execution state (GL side).
+    std::vector<uint32_t> m_order;
+    std::vector<float> m_batchVerts;
+    std::vector<RenderBatch> m_batches;
+    int m_viewportW = 0;
+    int m_viewportH = 0;
+    // Previous frame, kept for replay.
+    std::vector<RenderCommand> m_lastCommands;
+    std::vector<float> m_lastVerts;
+    std::vector<float> m_lastMatrices;
+    std::vector<uint32_t> m_lastOrder;
+    float m_lastClearColor[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+
+    // Packets travel main -> render through m_readyQueue and come back through m_freeQueue.
+    SpscQueue<RenderPacket*, kFramesInFlight + 1> m_readyQueue;
+    SpscQueue<RenderPacket*, kFramesInFlight + 1> m_freeQueue;
+#ifdef MAPMAKER_RENDER_THREAD
+    // The queues carry the packets; these only put an idle thread to sleep. Each side pushes,
+    // then notifies under m_wakeMutex so a waiter can't miss it between its check and its wait.
+    enum class ThreadStartup : uint8_t { Pending, Running, Failed };
+    void wakeRenderThread();
+    void wakeMainThread();
+    std::mutex m_wakeMutex;
+    std::condition_variable m_renderWake; // a packet is ready, or stop
+    std::condition_variable m_mainWake;   // a packet is free, or the thread has started up
+    ThreadStartup m_threadStartup = ThreadStartup::Pending;
+    std::thread m_thread;
+    std::atomic<bool> m_threadStop{false};
+    bool m_threaded = false;
+    SDL_Window* m_threadWindow = nullptr;
+    SDL_GLContext m_threadContext = nullptr;
+#endif
 
     GLuint m_texFloor = 0;
     GLuint m_texWall = 0;
     GLuint m_texCeil = 0;
+    GLuint m_texDoor = 0;
     GLuint m_texEnemySprite = 0;
     GLuint m_texProjectileSprite = 0;
     GLuint m_texItemHealth = 0;
@@ -0,0 +1,177 @@
+// Replay.cpp
+#include "Replay.h"
+#include "Platform.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+constexpr uint32_t kReplayMagic = 0x50524D4D; // "MMRP"
+constexpr uint16_t kReplayVersion = 5; // 2: sector floor/ceiling heights in the map block, 3: sector movers, 4: door lines, 5: spawners
+// Sticks and keys can add up past 1, so the range covers +-2.
+constexpr float kMoveScale = 63.0f;
+
+enum TickFlags : uint8_t {
+    TickBlock       = 1 << 0,
+    TickFire        = 1 << 1,
+    TickMoveChanged = 1 << 2,
+    TickLookChanged = 1 << 3,
+};
+
+int8_t quantizeMove(float v) {
+    return static_cast<int8_t>(std::lround(std::clamp(v, -2.0f, 2.0f) * kMoveScale));
+}
+
+void writePose(ByteWriter& out, const Camera3D& pose) {
+    out.f32(pose.x);
+    out.f32(pose.y);
+    out.f32(pose.z);
+    out.f32(pose.yaw);
+    out.f32(pose.pitch);
+}
+
+void readPose(ByteReader& in, Camera3D& pose) {
+    pose = Camera3D{};
+    pose.x = in.f32();
+    pose.y = in.f32();
+    pose.z = in.f32();
+    pose.yaw = in.f32();
+    pose.pitch = in.f32();
+}
+
+} // namespace
+
+void quantizePlayInput(PlayInput& input) {
+    input.moveX = quantizeMove(input.moveX) / kMoveScale;
+    input.moveY = quantizeMove(input.moveY) / kMoveScale;
+}
+
+void ReplayRecorder::begin(const EditorState& state, const Camera3D& player) {
+    m_map.clear();
+    ByteWriter map{m_map};
+    writeMap(state, map);
+    m_start = player;
+    m_ticks.clear();
+    m_last = PlayInput{};
+    m_tickCount = 0;
+    m_hash = hashPlayState(state, player);
+    m_active = true;
+}
+
+void ReplayRecorder::record(PlayInput& input) {
+    if (!m_active)
+        return;
+    quantizePlayInput(input);
+    ByteWriter out{m_ticks};
+    // Most ticks repeat the previous stick and look state; those cost one byte.
+    uint8_t flags = 0;
+    if (input.block) flags |= TickBlock;
+    if (input.fire) flags |= TickFire;
+    const bool moveChanged = input.moveX != m_last.moveX || input.moveY != m_last.moveY;
+    const bool lookChanged = input.yaw != m_last.yaw || input.pitch != m_last.pitch;
+    if (moveChanged) flags |= TickMoveChanged;
+    if (lookChanged) flags |= TickLookChanged;
+    out.u8(flags);
+    if (moveChanged) {
+        out.u8(static_cast<uint8_t>(quantizeMove(input.moveX)));
+        out.u8(static_cast<uint8_t>(quantizeMove(input.moveY)));
+    }
+    if (lookChanged) {
+        out.f32(input.yaw);
+        out.f32(input.pitch);
+    }
+    m_last = input;
+    ++m_tickCount;
+}
+
+void ReplayRecorder::recorded(const EditorState& state, const Camera3D& player) {
+    if (m_active)
+        m_hash = hashPlayState(state, player);
+}
+
+bool ReplayRecorder::finish(const char* path) {
+    if (!m_active)
+        return false;
+    m_active = false;
+    std::vector<uint8_t> file;
+    file.reserve(m_map.size() + m_ticks.size() + 64);
+    ByteWriter out{file};
+    out.u32(kReplayMagic);
+    out.u16(kReplayVersion);
+    out.u16(static_cast<uint16_t>(kPlayTickRate));
+    out.u32(static_cast<uint32_t>(m_map.size()));
+    file.insert(file.end(), m_map.begin(), m_map.end());
+    writePose(out, m_start);
+    out.u32(m_tickCount);
+    out.u64(m_hash);
+    out.u32(static_cast<uint32_t>(m_ticks.size()));
+    file.insert(file.end(), m_ticks.begin(), m_ticks.end());
+    if (!PlatformWriteFile(path, file)) {
+        std::printf("replay: could not write %s\n", path);
+        return false;
+    }
+    std::printf("replay: recorded %u ticks (%zu bytes) to %s\n", m_tickCount, file.size(), path);
+    return true;
+}
+
+bool ReplayReader::load(const char* path, EditorState& state) {
+    if (!PlatformReadFile(path, m_data)) {
+        std::printf("replay: could not read %s\n", path);
+        return false;
+    }
+    ByteReader in{m_data.data(), m_data.data() + m_data.size()};
+    if (in.u32() != kReplayMagic || in.u16() != kReplayVersion) {
+        std::printf("replay: %s is not a version %u replay\n", path, kReplayVersion);
+        return false;
+    }
+    if (in.u16() != static_cast<uint16_t>(kPlayTickRate)) {
+        std::printf("replay: %s was recorded at a different tick rate\n", path);
+        return false;
+    }
+    const uint32_t mapBytes = in.u32();
+    if (!in.need(mapBytes))
+        return false;
+    ByteReader map{in.p, in.p + mapBytes};
+    if (!readMap(map, state) || map.p != map.end) {
+        std::printf("replay: bad map block in %s\n", path);
+        return false;
+    }
+    in.p += mapBytes;
+    readPose(in, m_start);
+    m_tickCount = in.u32();
+    m_hash = in.u64();
+    const uint32_t tickBytes = in.u32();
+    if (!in.need(tickBytes)) {
+        std::printf("replay: %s is truncated\n", path);
+        return false;
+    }
+    m_stream = ByteReader{in.p, in.p + tickBytes};
+    m_last = PlayInput{};
+    m_ticksRead = 0;
+    std::printf("replay: %s, %u ticks (%.1f s)\n", path, m_tickCount, m_tickCount / kPlayTickRate);
+    return true;
+}
+
+bool ReplayReader::next(PlayInput& input) {
+    if (m_ticksRead >= m_tickCount)
+        return false;
+    const uint8_t flags = m_stream.u8();
+    PlayInput tick = m_last;
+    tick.block = (flags & TickBlock) != 0;
+    tick.fire = (flags & TickFire) != 0;
+    if (flags & TickMoveChanged) {
+        tick.moveX = static_cast<int8_t>(m_stream.u8()) / kMoveScale;
+        tick.moveY = static_cast<int8_t>(m_stream.u8()) / kMoveScale;
+    }
+    if (flags & TickLookChanged) {
+        tick.yaw = m_stream.f32();
+        tick.pitch = m_stream.f32();
+    }
+    if (!m_stream.ok)
+        return false;
+    m_last = tick;
+    input = tick;
+    ++m_ticksRead;
+    return true;
+}
@@ -0,0 +1,62 @@
+// Replay.h
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "EditorState.h"
+#include "MapIO.h"
+#include "PlaySim.h"
+
+// Play sessions are recorded as the map, the player's start pose and the PlayInput of every
+// tick. Feeding the inputs back through playTick reproduces the session exactly, and the
+// state hash stored at the end tells whether it did.
+
+// Rounds input to what the file stores. The recorder applies it before the tick runs, so the
+// live session already sees the values its replay will.
+void quantizePlayInput(PlayInput& input);
+
+class ReplayRecorder {
+public:
+    // Call right after playBegin.
+    void begin(const EditorState& state, const Camera3D& player);
+    // Quantizes input in place and appends it; call once per tick before playTick.
+    void record(PlayInput& input);
+    // Hashes the state a recorded tick left behind; call right after its playTick. The live
+    // camera picks up unticked look input between frames, so it is never hashed at exit.
+    void recorded(const EditorState& state, const Camera3D& player);
+    // Writes the file, ending with the hash of the last recorded tick, and stops recording.
+    bool finish(const char* path);
+    bool active() const { return m_active; }
+    uint32_t tickCount() const { return m_tickCount; }
+
+private:
+    std::vector<uint8_t> m_map;
+    Camera3D m_start;
+    std::vector<uint8_t> m_ticks;
+    PlayInput m_last;
+    uint32_t m_tickCount = 0;
+    uint64_t m_hash = 0;
+    bool m_active = false;
+};
+
+class ReplayReader {
+public:
+    // Reads the file and replaces the map in state. The caller compiles the level, calls
+    // playBegin and then places the player at startPose().
+    bool load(const char* path, EditorState& state);
+    const Camera3D& startPose() const { return m_start; }
+    // Next recorded tick; false once the stream is exhausted.
+    bool next(PlayInput& input);
+    uint32_t tickCount() const { return m_tickCount; }
+    uint32_t ticksRead() const { return m_ticksRead; }
+    uint64_t expectedHash() const { return m_hash; }
+
+private:
+    std::vector<uint8_t> m_data;
+    ByteReader m_stream{nullptr, nullptr};
+    Camera3D m_start;
+    PlayInput m_last;
+    uint32_t m_tickCount = 0;
+    uint32_t m_ticksRead = 0;
+    uint64_t m_hash = 0;
+};
@@ -0,0 +1,99 @@
+// Simd.h
+#pragma once
+
+// Minimal 4-wide float wrapper: SSE2 on x86, NEON on ARM (Switch), scalar elsewhere.
+// Comparisons return lane masks usable with simdOr and simdMoveMask.
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define MAPMAKER_SIMD_SSE2 1
+typedef __m128 simd4f;
+
+inline simd4f simdLoad(const float* p) { return _mm_loadu_ps(p); }
+inline void simdStore(float* p, simd4f v) { _mm_storeu_ps(p, v); }
+inline simd4f simdSplat(float v) { return _mm_set1_ps(v); }
+inline simd4f simdZero() { return _mm_setzero_ps(); }
+inline simd4f simdAdd(simd4f a, simd4f b) { return _mm_add_ps(a, b); }
+inline simd4f simdSub(simd4f a, simd4f b) { return _mm_sub_ps(a, b); }
+inline simd4f simdMul(simd4f a, simd4f b) { return _mm_mul_ps(a, b); }
+inline simd4f simdMadd(simd4f a, simd4f b, simd4f c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline simd4f simdMin(simd4f a, simd4f b) { return _mm_min_ps(a, b); }
+inline simd4f simdMax(simd4f a, simd4f b) { return _mm_max_ps(a, b); }
+inline simd4f simdLess(simd4f a, simd4f b) { return _mm_cmplt_ps(a, b); }
+inline simd4f simdOr(simd4f a, simd4f b) { return _mm_or_ps(a, b); }
+inline simd4f simdAnd(simd4f a, simd4f b) { return _mm_and_ps(a, b); }
+inline int simdMoveMask(simd4f m) { return _mm_movemask_ps(m); }
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MAPMAKER_SIMD_NEON 1
+typedef float32x4_t simd4f;
+
+inline simd4f simdLoad(const float* p) { return vld1q_f32(p); }
+inline void simdStore(float* p, simd4f v) { vst1q_f32(p, v); }
+inline simd4f simdSplat(float v) { return vdupq_n_f32(v); }
+inline simd4f simdZero() { return vdupq_n_f32(0.0f); }
+inline simd4f simdAdd(simd4f a, simd4f b) { return vaddq_f32(a, b); }
+inline simd4f simdSub(simd4f a, simd4f b) { return vsubq_f32(a, b); }
+inline simd4f simdMul(simd4f a, simd4f b) { return vmulq_f32(a, b); }
+inline simd4f simdMadd(simd4f a, simd4f b, simd4f c) { return vmlaq_f32(c, a, b); }
+inline simd4f simdMin(simd4f a, simd4f b) { return vminq_f32(a, b); }
+inline simd4f simdMax(simd4f a, simd4f b) { return vmaxq_f32(a, b); }
+inline simd4f simdLess(simd4f a, simd4f b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+inline simd4f simdOr(simd4f a, simd4f b) {
+    return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+inline simd4f simdAnd(simd4f a, simd4f b) {
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+inline int simdMoveMask(simd4f m) {
+    uint32x4_t u = vshrq_n_u32(vreinterpretq_u32_f32(m), 31);
+    return static_cast<int>(vgetq_lane_u32(u, 0) | (vgetq_lane_u32(u, 1) << 1) |
+                            (vgetq_lane_u32(u, 2) << 2) | (vgetq_lane_u32(u, 3) << 3));
+}
+
+#else
+#include <cstdint>
+#include <cstring>
+struct simd4f { float v[4]; };
+
+inline simd4f simdLoad(const float* p) { simd4f r; for (int i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+inline void simdStore(float* p, simd4f a) { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+inline simd4f simdSplat(float x) { simd4f r; for (int i = 0; i < 4; ++i) r.v[i] = x; return r; }
+inline simd4f simdZero() { return simdSplat(0.0f); }
+inline simd4f simdAdd(simd4f a, simd4f b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+inline simd4f simdSub(simd4f a, simd4f b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+inline simd4f simdMul(simd4f a, simd4f b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+inline simd4f simdMadd(simd4f a, simd4f b, simd4f c) { for (int i = 0; i < 4; ++i) c.v[i] += a.v[i] * b.v[i]; return c; }
+inline simd4f simdMin(simd4f a, simd4f b) { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return a; }
+inline simd4f simdMax(simd4f a, simd4f b) { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return a; }
+inline simd4f simdLess(simd4f a, simd4f b) {
+    simd4f r;
+    for (int i = 0; i < 4; ++i) {
+        uint32_t bits = a.v[i] < b.v[i] ? 0xFFFFFFFFu : 0u;
+        std::memcpy(&r.v[i], &bits, sizeof(bits));
+    }
+    return r;
+}
+inline simd4f simdBitwise(simd4f a, simd4f b, bool isOr) {
+    for (int i = 0; i < 4; ++i) {
+        uint32_t x, y;
+        std::memcpy(&x, &a.v[i], sizeof(x));
+        std::memcpy(&y, &b.v[i], sizeof(y));
+        uint32_t r = isOr ? (x | y) : (x & y);
+        std::memcpy(&a.v[i], &r, sizeof(r));
+    }
+    return a;
+}
+inline simd4f simdOr(simd4f a, simd4f b) { return simdBitwise(a, b, true); }
+inline simd4f simdAnd(simd4f a, simd4f b) { return simdBitwise(a, b, false); }
+inline int simdMoveMask(simd4f m) {
+    int mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint32_t bits;
+        std::memcpy(&bits, &m.v[i], sizeof(bits));
+        if (bits & 0x80000000u) mask |= 1 << i;
+    }
+    return mask;
+}
+#endif
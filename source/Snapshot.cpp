@@ -0,0 +1,161 @@
+// Snapshot.cpp
+#include "Snapshot.h"
+#include "EditorState.h"
+#include "Platform.h"
+
+namespace {
+
+// One projectile column: only the live prefix [0, count) is stored.
+void saveColumn(SnapshotWriter& out, const std::vector<float>& column, size_t count) {
+    out.bytes(column.data(), count * sizeof(float));
+}
+
+void loadColumn(SnapshotReader& in, std::vector<float>& column, size_t count) {
+    in.bytes(column.data(), count * sizeof(float));
+}
+
+// Everything playTick reads from one tick to the next. Derived data (the enemy hash, mover
+// heights in the level) is rebuilt on load rather than stored.
+void savePlayState(SnapshotWriter& out, const EditorState& state, const Camera3D& player) {
+    out.value(player);
+    out.value(state.blocking);
+    out.value(state.blockFlashTimer);
+    out.array(state.enemies.data(), state.enemies.size());
+    out.array(state.freeEnemies.data(), state.freeEnemies.size());
+    out.array(state.spawners.data(), state.spawners.size());
+
+    const ProjectileSystem& pool = state.projectiles;
+    out.value(static_cast<uint32_t>(pool.count));
+    saveColumn(out, pool.x, pool.count);
+    saveColumn(out, pool.y, pool.count);
+    saveColumn(out, pool.z, pool.count);
+    saveColumn(out, pool.vx, pool.count);
+    saveColumn(out, pool.vy, pool.count);
+    saveColumn(out, pool.vz, pool.count);
+    saveColumn(out, pool.prevX, pool.count);
+    saveColumn(out, pool.prevY, pool.count);
+    saveColumn(out, pool.prevZ, pool.count);
+    out.bytes(pool.flags.data(), pool.count);
+
+    out.array(state.doors.data(), state.doors.size());
+    out.array(state.activeDoors.data(), state.activeDoors.size());
+    out.array(state.items.data(), state.items.size());
+    out.array(state.movers.data(), state.movers.size());
+    state.triggers.saveState(out);
+    state.ai.saveState(out);
+    state.sight.saveState(out);
+    state.flow.saveState(out);
+}
+
+void loadPlayState(SnapshotReader& in, EditorState& state, Camera3D& player) {
+    in.value(player);
+    in.value(state.blocking);
+    in.value(state.blockFlashTimer);
+    in.array(state.enemies);
+    in.array(state.freeEnemies);
+    in.array(state.spawners);
+
+    ProjectileSystem& pool = state.projectiles;
+    uint32_t count = 0;
+    in.value(count);
+    pool.count = count;
+    loadColumn(in, pool.x, count);
+    loadColumn(in, pool.y, count);
+    loadColumn(in, pool.z, count);
+    loadColumn(in, pool.vx, count);
+    loadColumn(in, pool.vy, count);
+    loadColumn(in, pool.vz, count);
+    loadColumn(in, pool.prevX, count);
+    loadColumn(in, pool.prevY, count);
+    loadColumn(in, pool.prevZ, count);
+    in.bytes(pool.flags.data(), count);
+
+    in.array(state.doors);
+    in.array(state.activeDoors);
+    in.array(state.items);
+    in.array(state.movers);
+    for (size_t m = 0; m < state.movers.size(); ++m)
+        setMoverOffset(state.level, static_cast<int>(m), state.movers[m].offset);
+    state.triggers.loadState(in);
+    state.ai.loadState(in);
+    state.sight.loadState(in);
+    state.flow.loadState(in);
+    state.enemyHash.build(state.enemies);
+}
+
+} // namespace
+
+void SnapshotRing::reserve(size_t arenaBytes) {
+    m_arena.assign(arenaBytes, 0);
+    clear();
+}
+
+void SnapshotRing::clear() {
+    m_first = 0;
+    m_count = 0;
+    m_head = 0;
+    m_stats = SnapshotStats{};
+}
+
+bool SnapshotRing::capture(const EditorState& state, const Camera3D& player) {
+    const uint64_t startNs = PlatformTimeNs();
+    SnapshotWriter measure;
+    savePlayState(measure, state, player);
+    const size_t bytes = measure.size;
+    if (bytes > m_arena.size())
+        return false;
+
+    size_t offset = m_head;
+    if (offset + bytes > m_arena.size())
+        offset = 0;
+    // Drop oldest records until none overlaps the new one; anything older than an overlapping
+    // record has to go too, since the ring only ever forgets from the old end.
+    auto overlapsAny = [&]() {
+        for (size_t i = 0; i < m_count; ++i) {
+            const Record& r = at(i);
+            if (r.offset < offset + bytes && offset < r.offset + r.bytes)
+                return true;
+        }
+        return false;
+    };
+    while (m_count > 0 && (m_count == kMaxRecords || overlapsAny())) {
+        m_first = (m_first + 1) % kMaxRecords;
+        --m_count;
+    }
+
+    SnapshotWriter out;
+    out.p = m_arena.data() + offset;
+    savePlayState(out, state, player);
+    m_records[(m_first + m_count) % kMaxRecords] = { offset, bytes, state.ai.tick() };
+    ++m_count;
+    m_head = offset + bytes;
+
+    m_stats.records = m_count;
+    m_stats.lastBytes = bytes;
+    m_stats.peakBytes = bytes > m_stats.peakBytes ? bytes : m_stats.peakBytes;
+    m_stats.lastCaptureNs = PlatformTimeNs() - startNs;
+    return true;
+}
+
+bool SnapshotRing::restore(EditorState& state, Camera3D& player, uint32_t tick) {
+    if (m_count == 0)
+        return false;
+    const uint64_t startNs = PlatformTimeNs();
+    size_t keep = 1;
+    for (size_t i = m_count; i > 0; --i) {
+        if (at(i - 1).tick <= tick) {
+            keep = i;
+            break;
+        }
+    }
+    m_count = keep;
+    const Record& r = at(keep - 1);
+    m_head = r.offset + r.bytes;
+
+    SnapshotReader in{ m_arena.data() + r.offset };
+    loadPlayState(in, state, player);
+
+    m_stats.records = m_count;
+    m_stats.lastRestoreNs = PlatformTimeNs() - startNs;
+    return true;
+}
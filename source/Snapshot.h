@@ -0,0 +1,113 @@
+// Snapshot.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+struct EditorState;
+struct Camera3D;
+
+// Play ticks between checkpoints, and how far back a rewind (or a hit) puts play.
+constexpr uint32_t kSnapshotIntervalTicks = 60; // 0.5 s
+constexpr uint32_t kRewindTicks = 240;          // 2 s
+// Arena for a ring; a thousand enemies under five thousand shots take about 230 KB a record.
+constexpr size_t kSnapshotArenaBytes = 16u << 20;
+
+// Raw memcpy writer for in-memory snapshots. With p null it only counts, so the same save
+// code measures a record before writing it. Snapshots never leave the process, so unlike
+// ByteWriter there is no byte order and no bounds check.
+struct SnapshotWriter {
+    uint8_t* p = nullptr;
+    size_t size = 0;
+
+    void bytes(const void* data, size_t count) {
+        if (p && count > 0)
+            std::memcpy(p + size, data, count);
+        size += count;
+    }
+    template <typename T>
+    void value(const T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied as bytes");
+        bytes(&v, sizeof(T));
+    }
+    // Element count, then the elements.
+    template <typename T>
+    void array(const T* data, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot arrays are copied as bytes");
+        value(static_cast<uint32_t>(count));
+        bytes(data, count * sizeof(T));
+    }
+};
+
+struct SnapshotReader {
+    const uint8_t* p;
+
+    void bytes(void* data, size_t count) {
+        if (count > 0)
+            std::memcpy(data, p, count);
+        p += count;
+    }
+    template <typename T>
+    void value(T& v) { bytes(&v, sizeof(T)); }
+    // Resizes out to the stored count; no allocation as long as it has held that many before.
+    template <typename T>
+    void array(std::vector<T>& out) {
+        uint32_t count = 0;
+        value(count);
+        out.resize(count);
+        bytes(out.data(), count * sizeof(T));
+    }
+};
+
+struct SnapshotStats {
+    size_t records = 0;
+    size_t lastBytes = 0;
+    size_t peakBytes = 0;
+    uint64_t lastCaptureNs = 0;
+    uint64_t lastRestoreNs = 0;
+};
+
+// Play-state checkpoints (camera, enemies and spawners, live projectiles, doors, items, movers
+// and the trigger, AI and sight state that goes with them) in a ring over one preallocated arena.
+// Records are laid end to end; one that doesn't fit before the end of the arena wraps to the
+// start and drops the old records it would overwrite. Ticks are the AI scheduler's, which
+// counts from the start of the session and is restored with everything else.
+class SnapshotRing {
+public:
+    static constexpr size_t kMaxRecords = 64;
+
+    SnapshotRing() = default;
+    SnapshotRing(const SnapshotRing&) = delete;
+    SnapshotRing& operator=(const SnapshotRing&) = delete;
+
+    // Allocates the arena; capture and restore never allocate it again.
+    void reserve(size_t arenaBytes);
+    void clear();
+
+    // Records the current play state. False, recording nothing, if it is larger than the arena.
+    bool capture(const EditorState& state, const Camera3D& player);
+    // Puts back the newest record taken at or before tick (the oldest one if none is that old)
+    // and forgets the records after it. False when the ring is empty.
+    bool restore(EditorState& state, Camera3D& player, uint32_t tick);
+
+    const SnapshotStats& stats() const { return m_stats; }
+
+private:
+    struct Record {
+        size_t offset;
+        size_t bytes;
+        uint32_t tick;
+    };
+
+    const Record& at(size_t i) const { return m_records[(m_first + i) % kMaxRecords]; }
+
+    std::vector<uint8_t> m_arena;
+    Record m_records[kMaxRecords];
+    size_t m_first = 0; // oldest record
+    size_t m_count = 0;
+    size_t m_head = 0;  // arena offset just past the newest record
+    SnapshotStats m_stats;
+};
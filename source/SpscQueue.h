@@ -0,0 +1,39 @@
+// SpscQueue.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// One slot is kept empty to tell full from empty, so it holds Capacity - 1 items.
+template <typename T, size_t Capacity>
+class SpscQueue {
+public:
+    bool push(const T& value) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t next = (head + 1) % Capacity;
+        if (next == m_tail.load(std::memory_order_acquire))
+            return false;
+        m_items[head] = value;
+        m_head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+            return false;
+        out = m_items[tail];
+        m_tail.store((tail + 1) % Capacity, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+    T m_items[Capacity];
+};
@@ -0,0 +1,112 @@
+// Triggers.cpp
+#include "Triggers.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cmath>
+
+void TriggerSystem::clear() {
+    m_volumes.clear();
+    m_width = m_height = 0;
+    m_cellStart.clear();
+    m_cellItems.clear();
+    m_inside.clear();
+    m_nowInside.clear();
+    m_events.clear();
+}
+
+int TriggerSystem::add(TriggerKind kind, int target, float x, float y, float radius) {
+    m_volumes.push_back({ x, y, radius, target, kind, true });
+    return static_cast<int>(m_volumes.size()) - 1;
+}
+
+void TriggerSystem::build() {
+    m_width = m_height = 0;
+    m_cellStart.clear();
+    m_cellItems.clear();
+    m_inside.clear();
+    if (m_volumes.empty())
+        return;
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    for (const Volume& v : m_volumes) {
+        minX = std::min(minX, v.x - v.radius);
+        minY = std::min(minY, v.y - v.radius);
+        maxX = std::max(maxX, v.x + v.radius);
+        maxY = std::max(maxY, v.y + v.radius);
+    }
+    m_originX = minX;
+    m_originY = minY;
+    m_width = static_cast<int>((maxX - minX) / kCellSize) + 1;
+    m_height = static_cast<int>((maxY - minY) / kCellSize) + 1;
+    const size_t cellCount = static_cast<size_t>(m_width) * m_height;
+
+    // Each volume goes in every cell its bounding box touches: count, prefix-sum, fill.
+    auto forEachCell = [&](const Volume& v, auto&& fn) {
+        const int x0 = static_cast<int>((v.x - v.radius - m_originX) / kCellSize);
+        const int y0 = static_cast<int>((v.y - v.radius - m_originY) / kCellSize);
+        const int x1 = std::min(static_cast<int>((v.x + v.radius - m_originX) / kCellSize), m_width - 1);
+        const int y1 = std::min(static_cast<int>((v.y + v.radius - m_originY) / kCellSize), m_height - 1);
+        for (int cy = std::max(y0, 0); cy <= y1; ++cy) {
+            for (int cx = std::max(x0, 0); cx <= x1; ++cx)
+                fn(static_cast<size_t>(cy) * m_width + cx);
+        }
+    };
+    m_cellStart.assign(cellCount + 1, 0);
+    for (const Volume& v : m_volumes)
+        forEachCell(v, [&](size_t cell) { ++m_cellStart[cell + 1]; });
+    for (size_t c = 0; c < cellCount; ++c)
+        m_cellStart[c + 1] += m_cellStart[c];
+    m_cellItems.resize(m_cellStart[cellCount]);
+    std::vector<uint32_t> cursor(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (size_t i = 0; i < m_volumes.size(); ++i)
+        forEachCell(m_volumes[i], [&](size_t cell) { m_cellItems[cursor[cell]++] = static_cast<int32_t>(i); });
+}
+
+const std::vector<TriggerEvent>& TriggerSystem::update(float x, float y) {
+    m_events.clear();
+    m_nowInside.clear();
+    if (m_width > 0) {
+        const int cx = static_cast<int>(std::floor((x - m_originX) / kCellSize));
+        const int cy = static_cast<int>(std::floor((y - m_originY) / kCellSize));
+        if (cx >= 0 && cy >= 0 && cx < m_width && cy < m_height) {
+            const size_t cell = static_cast<size_t>(cy) * m_width + cx;
+            for (uint32_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) {
+                const Volume& v = m_volumes[m_cellItems[i]];
+                const float dx = x - v.x;
+                const float dy = y - v.y;
+                if (v.enabled && dx * dx + dy * dy < v.radius * v.radius)
+                    m_nowInside.push_back(m_cellItems[i]);
+            }
+            std::sort(m_nowInside.begin(), m_nowInside.end());
+        }
+    }
+    // Merge the sorted before/after sets; anything in only one of them crossed a boundary.
+    size_t a = 0, b = 0;
+    while (a < m_inside.size() || b < m_nowInside.size()) {
+        if (b == m_nowInside.size() || (a < m_inside.size() && m_inside[a] < m_nowInside[b])) {
+            const Volume& v = m_volumes[m_inside[a]];
+            m_events.push_back({ v.kind, v.target, m_inside[a], false });
+            ++a;
+        } else if (a == m_inside.size() || m_nowInside[b] < m_inside[a]) {
+            const Volume& v = m_volumes[m_nowInside[b]];
+            m_events.push_back({ v.kind, v.target, m_nowInside[b], true });
+            ++b;
+        } else {
+            ++a;
+            ++b;
+        }
+    }
+    m_inside.swap(m_nowInside);
+    return m_events;
+}
+
+void TriggerSystem::saveState(SnapshotWriter& out) const {
+    for (const Volume& v : m_volumes)
+        out.value(v.enabled);
+    out.array(m_inside.data(), m_inside.size());
+}
+
+void TriggerSystem::loadState(SnapshotReader& in) {
+    for (Volume& v : m_volumes)
+        in.value(v.enabled);
+    in.array(m_inside);
+}
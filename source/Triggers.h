@@ -0,0 +1,68 @@
+// Triggers.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct SnapshotReader;
+struct SnapshotWriter;
+
+enum class TriggerKind : uint8_t {
+    Door, // target is an index into EditorState::doors
+    Item, // target is an index into EditorState::items
+    Mover, // target is an index into Level::movers
+};
+
+struct TriggerEvent {
+    TriggerKind kind;
+    int target;
+    int trigger;
+    bool entered; // false when leaving
+};
+
+// Circular trigger volumes binned into a uniform grid. Each tick only the volumes in the
+// player's cell are tested, and events come out only when the player crosses a boundary, so
+// the cost follows the triggers nearby rather than how many the map has.
+class TriggerSystem {
+public:
+    static constexpr float kCellSize = 2.0f;
+
+    void clear();
+    // Register everything, then build() once.
+    int add(TriggerKind kind, int target, float x, float y, float radius);
+    void build();
+    // A disabled volume is skipped; if the player was inside it, it reports a leave.
+    void setEnabled(int trigger, bool enabled) { m_volumes[trigger].enabled = enabled; }
+
+    // Tests the point against nearby volumes and returns the crossings since the last call,
+    // in trigger order.
+    const std::vector<TriggerEvent>& update(float x, float y);
+
+    size_t size() const { return m_volumes.size(); }
+
+    // Enabled flags and who is inside, for play snapshots; the volumes themselves don't change.
+    void saveState(SnapshotWriter& out) const;
+    void loadState(SnapshotReader& in);
+
+private:
+    struct Volume {
+        float x;
+        float y;
+        float radius;
+        int target;
+        TriggerKind kind;
+        bool enabled;
+    };
+
+    std::vector<Volume> m_volumes;
+    float m_originX = 0.0f;
+    float m_originY = 0.0f;
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<uint32_t> m_cellStart; // CSR, as in Blockmap
+    std::vector<int32_t> m_cellItems;
+    std::vector<int32_t> m_inside;     // sorted, as of the last update
+    std::vector<int32_t> m_nowInside;
+    std::vector<TriggerEvent> m_events;
+};
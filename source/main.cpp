@@ -17,6 +17,7 @@
 #include <utility>
 #include <vector>
 #include <cstdio>
+#include <cstring>
 
 #if defined(__EMSCRIPTEN__)
 #include <emscripten/emscripten.h>
@@ -28,7 +29,13 @@
 
 #include "Platform.h"
 #include "RendererGL.h"
+#include "Collision.h"
 #include "EditorState.h"
+#include "MapIO.h"
+#include "PlaySim.h"
+#include "Portals.h"
+#include "Replay.h"
+#include "Snapshot.h"
 
 static int findVertexAt(const EditorState& state, float x, float y, float eps = 0.0001f) {
     for (size_t i = 0; i < state.vertices.size(); ++i) {
@@ -148,24 +155,6 @@ static void setMouseCapture(SDL_Window* window, bool capture) {
 }
 #endif
 
-static Vec2 closestPointOnSegment(float px, float py, float ax, float ay, float bx, float by) {
-    float vx = bx - ax;
-    float vy = by - ay;
-    float wx = px - ax;
-    float wy = py - ay;
-    float len2 = vx * vx + vy * vy;
-    float t = (len2 > 0.0f) ? ((wx * vx + wy * vy) / len2) : 0.0f;
-    if (t < 0.0f) t = 0.0f;
-    if (t > 1.0f) t = 1.0f;
-    return { ax + vx * t, ay + vy * t };
-}
-
-static float distance2D(float x1, float y1, float x2, float y2) {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    return std::sqrt(dx * dx + dy * dy);
-}
-
 static bool segmentsIntersect(const Vec2& a1, const Vec2& a2, const Vec2& b1, const Vec2& b2) {
     auto cross = [](float x1, float y1, float x2, float y2) { return x1 * y2 - y1 * x2; };
     float dxa = a2.x - a1.x, dya = a2.y - a1.y;
@@ -201,7 +190,8 @@ static EntityType nextEntityBrush(EntityType t) {
         case EntityType::PlayerStart: return EntityType::EnemyWizard;
         case EntityType::EnemyWizard: return EntityType::ItemPickup;
         case EntityType::ItemPickup:  return EntityType::Door;
-        case EntityType::Door:        return EntityType::PlayerStart;
+        case EntityType::Door:        return EntityType::Spawner;
+        case EntityType::Spawner:     return EntityType::PlayerStart;
     }
     return EntityType::PlayerStart;
 }
@@ -212,92 +202,13 @@ static const char* entityTypeName(EntityType t) {
         case EntityType::EnemyWizard: return "EnemyWizard";
         case EntityType::ItemPickup:  return "ItemPickup";
         case EntityType::Door:        return "Door";
+        case EntityType::Spawner:     return "Spawner";
     }
     return "Unknown";
 }
 
-static void spawnProjectile(EditorState& state, float x, float y, float z,
-                            float vx, float vy, float vz, bool fromPlayer) {
-    Projectile p{ x, y, z, vx, vy, vz, fromPlayer, true };
-    state.projectiles.active.push_back(p);
-}
-
 static std::vector<std::vector<int>> findClosedLoops(const EditorState& state);
 
-static void buildDefaultMap(EditorState& state) {
-    state.vertices.clear();
-    state.lines.clear();
-    state.entities.clear();
-    state.sectors.clear();
-
-    const std::vector<std::pair<float, float>> verts = {
-      {0.0f, 0.0f},    // 0 bottom left
-        {0.0f, 10.0f},   // 1 top left
-        {10.0f, 10.0f},  // 2 top entry start
-        {10.0f, 6.0f},   // 3 vertical hall cutout (top)
-        {12.0f, 6.0f},   // 4 vertical hall cutout (top)
-        {12.0f, 10.0f},  // 5 back to top edge
-        {22.0f, 10.0f},
-        {22.0f, 6.0f},   // 6 vertical hall cutout (top)
-        {24.0f, 6.0f},   // 7 vertical hall cutout (top)
-        {24.0f, 10.0f},  // 8 back to top edge
-        {34.0f, 10.0f},  // 10 slight rise near right end
-        {34.0f, 6.0f},
-        {36.0f, 6.0f},
-        {36.0f, 11.0f},  // 6 slight rise toward right end
-        {48.0f, 11.0f},  // 7 far top right
-        {48.0f, -1.0f},  // 8 far bottom right
-        {36.0f, -1.0f},  // 9 slight drop near right end
-        {36.0f, 4.0f},   // 10 angled return
-        {34.0f, 4.0f},   // 11 angled return
-        {34.0f, 0.0f},   // 10 angled return
-        {24.0f, 0.0f},   // 11 mid bottom
-        {24.0f, 4.0f},   // 12 bottom hall cutout top
-        {22.0f, 4.0f},   // 13 bottom hall cutout top (left)
-        {22.0f, 0.0f},   // 14 return down
-        {12.0f, 0.0f},   // 15 bottom near entry
-        {12.0f, 4.0f},   // 16 bottom hall cutout top (right)
-        {10.0f, 4.0f},   // 17 bottom hall cutout top (left)
-        {10.0f, 0.0f},   // 18 close to origin along bottom
-    };
-
-    for (const auto& v : verts) {
-        state.vertices.push_back(v);
-    }
-
-    auto addLine = [&](uint16_t a, uint16_t b) { state.lines.push_back({a, b}); };
-    for (uint16_t i = 0; i < static_cast<uint16_t>(state.vertices.size()); ++i) {
-        uint16_t next = static_cast<uint16_t>((i + 1) % state.vertices.size());
-        addLine(i, next);
-    }
-    // Entities
-    state.entities.push_back({5.0f, 5.0f, EntityType::PlayerStart});
-    state.entities.push_back({17.0f, 5.0f, EntityType::EnemyWizard});
-    state.entities.push_back({29.0f, 5.0f, EntityType::ItemPickup});
-    state.entities.push_back({39.0f, 5.0f, EntityType::EnemyWizard});
-    state.entities.push_back({43.0f, 3.0f, EntityType::EnemyWizard});
-    state.entities.push_back({43.0f, 7.0f, EntityType::EnemyWizard});
-    // Doors at corridor midpoints
-    state.entities.push_back({11.0f, 5.0f, EntityType::Door});
-    state.entities.push_back({23.0f, 5.0f, EntityType::Door});
-    state.entities.push_back({35.0f, 5.0f, EntityType::Door});
-
-    // Single sector covering the whole footprint
-    Sector s;
-    s.vertices.resize(state.vertices.size());
-    for (size_t i = 0; i < state.vertices.size(); ++i) {
-        s.vertices[i] = static_cast<int>(i);
-    }
-    float area = 0.0f;
-    for (size_t i = 0; i < s.vertices.size(); ++i) {
-        const auto& p0 = state.vertices[s.vertices[i]];
-        const auto& p1 = state.vertices[s.vertices[(i + 1) % s.vertices.size()]];
-        area += p0.first * p1.second - p1.first * p0.second;
-    }
-    s.clockwise = (area < 0.0f);
-    state.sectors.push_back(std::move(s));
-}
-
 static bool earClip(const std::vector<Vec2>& poly, const std::vector<uint16_t>& localIdx, std::vector<uint16_t>& out) {
     if (poly.size() < 3) return false;
     float area = 0.0f;
@@ -347,20 +258,33 @@ static bool earClip(const std::vector<Vec2>& poly, const std::vector<uint16_t>&
     return out.size() % 3 == 0;
 }
 
-static void rebuildWorldMesh(const EditorState& state, Mesh3D& mesh,
-                             float floorHeight = 0.0f, float ceilingHeight = 3.0f) {
+static void rebuildWorldMesh(const EditorState& state, Mesh3D& mesh) {
     mesh.vertices.clear();
     mesh.normals.clear();
     mesh.colors.clear();
     mesh.uvs.clear();
+    mesh.movers.clear();
     mesh.indices.clear();
     mesh.floorIndexStart = mesh.floorIndexCount = 0;
     mesh.ceilingIndexStart = mesh.ceilingIndexCount = 0;
     mesh.wallIndexStart = mesh.wallIndexCount = 0;
+    mesh.doorIndexStart = mesh.doorIndexCount = 0;
+    mesh.doors.clear();
+    mesh.chunks.clear();
+    mesh.sectorChunkStart.assign(state.sectors.size() + 1, 0);
+    mesh.chunkMinX.clear();
+    mesh.chunkMinY.clear();
+    mesh.chunkMinZ.clear();
+    mesh.chunkMaxX.clear();
+    mesh.chunkMaxY.clear();
+    mesh.chunkMaxZ.clear();
+    ++mesh.revision;
 
     uint16_t baseIndex = 0;
 
-    auto addVertex = [&](float x, float y, float z, float nx, float ny, float nz, float r, float g, float b, float u, float v) -> uint16_t {
+    auto addVertex = [&](float x, float y, float z, float nx, float ny, float nz, float r, float g, float b, float u, float v,
+                         int moverSlot = 0, float vPerZ = 0.0f,
+                         float minZ = -kMoverNoClamp, float maxZ = kMoverNoClamp) -> uint16_t {
         mesh.vertices.push_back(x);
         mesh.vertices.push_back(y);
         mesh.vertices.push_back(z);
@@ -372,25 +296,69 @@ static void rebuildWorldMesh(const EditorState& state, Mesh3D& mesh,
         mesh.colors.push_back(b);
         mesh.uvs.push_back(u);
         mesh.uvs.push_back(v);
+        mesh.movers.push_back(static_cast<float>(moverSlot));
+        mesh.movers.push_back(vPerZ);
+        mesh.movers.push_back(minZ);
+        mesh.movers.push_back(maxZ);
         return baseIndex++;
     };
 
-    for (const auto& sector : state.sectors) {
+    // Vertices on a door's ceiling or a lift's floor carry that mover's slot (mover + 1) and
+    // are offset in the vertex shader, so the mesh is built once at the planes' rest heights.
+    auto moverSlot = [&](size_t s, SectorMover kind) {
+        const int m = s < state.level.sectors.size() ? state.level.sectors[s].mover : -1;
+        return m >= 0 && state.level.movers[m].kind == kind ? m + 1 : 0;
+    };
+    auto slotTravel = [&](int slot) { return slot > 0 ? state.level.movers[slot - 1].travel : 0.0f; };
+
+    // Indices are collected per material and concatenated at the end so each material is
+    // one contiguous range and consecutive visible chunks draw as a single call.
+    std::vector<uint16_t> floorIdx;
+    std::vector<uint16_t> ceilIdx;
+    std::vector<uint16_t> wallIdx;
+
+    auto addChunk = [&](const MeshChunk& chunk, float minX, float minY, float minZ, float maxX, float maxY, float maxZ) {
+        mesh.chunks.push_back(chunk);
+        mesh.chunkMinX.push_back(minX);
+        mesh.chunkMinY.push_back(minY);
+        mesh.chunkMinZ.push_back(minZ);
+        mesh.chunkMaxX.push_back(maxX);
+        mesh.chunkMaxY.push_back(maxY);
+        mesh.chunkMaxZ.push_back(maxZ);
+    };
+
+    // Long wall runs (big outdoor sectors) are split so off-screen parts can be culled.
+    const size_t wallsPerChunk = 8;
+    // Wall textures repeat every this many units up, measured from z = 0 so steps line up.
+    const float wallTextureHeight = 3.0f;
+
+    for (size_t sectorIndex = 0; sectorIndex < state.sectors.size(); ++sectorIndex) {
+        const auto& sector = state.sectors[sectorIndex];
+        mesh.sectorChunkStart[sectorIndex] = static_cast<uint32_t>(mesh.chunks.size());
         if (sector.vertices.size() < 3)
             continue;
+        const float floorHeight = sector.floorHeight;
+        const float ceilingHeight = sector.ceilingHeight;
+        const int floorSlot = moverSlot(sectorIndex, SectorMover::Lift);
+        const int ceilingSlot = moverSlot(sectorIndex, SectorMover::Door);
 
         std::vector<uint16_t> floorLocal;
         std::vector<uint16_t> ceilLocal;
         std::vector<Vec2> poly2d;
+        float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
         for (int idx : sector.vertices) {
             if (idx < 0 || idx >= static_cast<int>(state.vertices.size()))
                 continue;
             const auto& v = state.vertices[idx];
             float u = v.first * 0.25f;
             float vv = v.second * 0.25f;
-            floorLocal.push_back(addVertex(v.first, v.second, floorHeight, 0.0f, 0.0f, 1.0f, 0.5f, 0.35f, 0.2f, u, vv));
-            ceilLocal.push_back(addVertex(v.first, v.second, ceilingHeight, 0.0f, 0.0f, -1.0f, 0.65f, 0.65f, 0.7f, u, vv));
+            floorLocal.push_back(addVertex(v.first, v.second, floorHeight, 0.0f, 0.0f, 1.0f, 0.5f, 0.35f, 0.2f, u, vv, floorSlot));
+            ceilLocal.push_back(addVertex(v.first, v.second, ceilingHeight, 0.0f, 0.0f, -1.0f, 0.65f, 0.65f, 0.7f, u, vv, ceilingSlot));
             poly2d.push_back({v.first, v.second});
+            minX = std::min(minX, v.first);
+            minY = std::min(minY, v.second);
+            maxX = std::max(maxX, v.first);
+            maxY = std::max(maxY, v.second);
         }
 
         std::vector<uint16_t> triFloor;
@@ -405,13 +373,6 @@ static void rebuildWorldMesh(const EditorState& state, Mesh3D& mesh,
                 }
             }
         }
-        size_t floorStart = mesh.indices.size();
-        for (uint16_t t : triFloor) mesh.indices.push_back(t);
-        size_t addedFloor = mesh.indices.size() - floorStart;
-        if (addedFloor > 0) {
-            if (mesh.floorIndexCount == 0) mesh.floorIndexStart = floorStart;
-            mesh.floorIndexCount += addedFloor;
-        }
 
         std::vector<uint16_t> triCeil;
         if (!earClip(poly2d, ceilLocal, triCeil)) {
@@ -425,26 +386,71 @@ static void rebuildWorldMesh(const EditorState& state, Mesh3D& mesh,
                 }
             }
         }
-        size_t ceilStart = mesh.indices.size();
+
+        MeshChunk planes;
+        planes.sector = static_cast<int>(sectorIndex);
+        planes.floorStart = static_cast<uint32_t>(floorIdx.size());
+        for (uint16_t t : triFloor) floorIdx.push_back(t);
+        planes.floorCount = static_cast<uint32_t>(floorIdx.size()) - planes.floorStart;
+        planes.ceilingStart = static_cast<uint32_t>(ceilIdx.size());
         // reverse winding for ceiling
         for (size_t i = 0; i + 2 < triCeil.size(); i += 3) {
-            mesh.indices.push_back(triCeil[i]);
-            mesh.indices.push_back(triCeil[i + 2]);
-            mesh.indices.push_back(triCeil[i + 1]);
-        }
-        size_t addedCeil = mesh.indices.size() - ceilStart;
-        if (addedCeil > 0) {
-            if (mesh.ceilingIndexCount == 0) mesh.ceilingIndexStart = ceilStart;
-            mesh.ceilingIndexCount += addedCeil;
+            ceilIdx.push_back(triCeil[i]);
+            ceilIdx.push_back(triCeil[i + 2]);
+            ceilIdx.push_back(triCeil[i + 1]);
         }
-
-        size_t wallStart = mesh.indices.size();
+        planes.ceilingCount = static_cast<uint32_t>(ceilIdx.size()) - planes.ceilingStart;
+        planes.wallStart = static_cast<uint32_t>(wallIdx.size());
+        addChunk(planes, minX, minY, floorHeight + slotTravel(floorSlot), maxX, maxY, ceilingHeight);
+
+        MeshChunk walls;
+        float wMinX = 1e30f, wMinY = 1e30f, wMinZ = 1e30f, wMaxX = -1e30f, wMaxY = -1e30f, wMaxZ = -1e30f;
+        size_t wallsInChunk = 0;
+        auto flushWalls = [&]() {
+            if (wallsInChunk == 0)
+                return;
+            walls.wallCount = static_cast<uint32_t>(wallIdx.size()) - walls.wallStart;
+            walls.floorStart = static_cast<uint32_t>(floorIdx.size());
+            walls.ceilingStart = static_cast<uint32_t>(ceilIdx.size());
+            addChunk(walls, wMinX, wMinY, wMinZ, wMaxX, wMaxY, wMaxZ);
+            wallsInChunk = 0;
+        };
         for (size_t i = 0; i < sector.vertices.size(); ++i) {
             int idxA = sector.vertices[i];
             int idxB = sector.vertices[(i + 1) % sector.vertices.size()];
             if (idxA < 0 || idxA >= static_cast<int>(state.vertices.size()) ||
                 idxB < 0 || idxB >= static_cast<int>(state.vertices.size()))
                 continue;
+            // Solid edges are wall from floor to ceiling. Edges shared with another sector are
+            // portals and stay open, except for a riser up to a higher floor beyond and a lip
+            // down to a lower ceiling; each side draws the pieces facing into it. Pieces next to a
+            // moving plane are kept if the move can ever open them up.
+            struct WallPiece {
+                float bottom;
+                float top;
+                int bottomSlot;
+                int topSlot;
+            };
+            WallPiece pieces[2] = { { floorHeight, ceilingHeight, floorSlot, ceilingSlot }, {} };
+            int pieceCount = 1;
+            if (sectorIndex < state.level.sectors.size()) {
+                const LevelSector& ls = state.level.sectors[sectorIndex];
+                const int other = i < ls.edgeCount ? state.level.edges[ls.firstEdge + i].otherSector : -1;
+                if (other >= 0) {
+                    const Sector& beyond = state.sectors[other];
+                    const int beyondFloorSlot = moverSlot(other, SectorMover::Lift);
+                    const int beyondCeilingSlot = moverSlot(other, SectorMover::Door);
+                    pieceCount = 0;
+                    if (beyond.floorHeight > floorHeight + slotTravel(floorSlot)) {
+                        pieces[pieceCount++] = { floorHeight, std::min(beyond.floorHeight, ceilingHeight),
+                                                 floorSlot, beyondFloorSlot };
+                    }
+                    if (beyond.ceilingHeight + slotTravel(beyondCeilingSlot) < ceilingHeight) {
+                        pieces[pieceCount++] = { std::max(beyond.ceilingHeight, floorHeight), ceilingHeight,
+                                                 beyondCeilingSlot, ceilingSlot };
+                    }
+                }
+            }
             const auto& vA = state.vertices[idxA];
             const auto& vB = state.vertices[idxB];
             float edgeX = vB.first - vA.first;
@@ -458,32 +464,157 @@ static void rebuildWorldMesh(const EditorState& state, Mesh3D& mesh,
             }
             float uA = 0.0f;
             float uB = len;
-            float vLower = floorHeight / ceilingHeight;
-            float vUpper = 1.0f;
-
-            uint16_t a0 = addVertex(vA.first, vA.second, floorHeight, nx, ny, 0.0f, 0.6f, 0.6f, 0.6f, uA, vLower);
-            uint16_t b0 = addVertex(vB.first, vB.second, floorHeight, nx, ny, 0.0f, 0.6f, 0.6f, 0.6f, uB, vLower);
-            uint16_t b1 = addVertex(vB.first, vB.second, ceilingHeight, nx, ny, 0.0f, 0.6f, 0.6f, 0.6f, uB, vUpper);
-            uint16_t a1 = addVertex(vA.first, vA.second, ceilingHeight, nx, ny, 0.0f, 0.6f, 0.6f, 0.6f, uA, vUpper);
-
-            mesh.indices.push_back(a0);
-            mesh.indices.push_back(b0);
-            mesh.indices.push_back(b1);
-            mesh.indices.push_back(a0);
-            mesh.indices.push_back(b1);
-            mesh.indices.push_back(a1);
+
+            for (int piece = 0; piece < pieceCount; ++piece) {
+                const WallPiece& wp = pieces[piece];
+                const float bottom = wp.bottom;
+                const float top = wp.top;
+                if (top <= bottom && wp.bottomSlot == 0 && wp.topSlot == 0)
+                    continue;
+                const float vLower = bottom / wallTextureHeight;
+                const float vUpper = top / wallTextureHeight;
+
+                if (wallsInChunk == 0) {
+                    walls = MeshChunk{};
+                    walls.sector = static_cast<int>(sectorIndex);
+                    walls.wallStart = static_cast<uint32_t>(wallIdx.size());
+                    wMinX = wMinY = wMinZ = 1e30f;
+                    wMaxX = wMaxY = wMaxZ = -1e30f;
+                }
+
+                // A moving end stops at the other end's rest height, so the piece flattens
+                // instead of turning inside out once the planes pass each other.
+                const float vPerZ = 1.0f / wallTextureHeight;
+                const float bottomMaxZ = wp.bottomSlot > 0 ? top : kMoverNoClamp;
+                const float topMinZ = wp.topSlot > 0 ? bottom : -kMoverNoClamp;
+                uint16_t a0 = addVertex(vA.first, vA.second, bottom, nx, ny, 0.0f, 0.6f, 0.6f, 0.6f, uA, vLower,
+                                        wp.bottomSlot, vPerZ, -kMoverNoClamp, bottomMaxZ);
+                uint16_t b0 = addVertex(vB.first, vB.second, bottom, nx, ny, 0.0f, 0.6f, 0.6f, 0.6f, uB, vLower,
+                                        wp.bottomSlot, vPerZ, -kMoverNoClamp, bottomMaxZ);
+                uint16_t b1 = addVertex(vB.first, vB.second, top, nx, ny, 0.0f, 0.6f, 0.6f, 0.6f, uB, vUpper,
+                                        wp.topSlot, vPerZ, topMinZ, kMoverNoClamp);
+                uint16_t a1 = addVertex(vA.first, vA.second, top, nx, ny, 0.0f, 0.6f, 0.6f, 0.6f, uA, vUpper,
+                                        wp.topSlot, vPerZ, topMinZ, kMoverNoClamp);
+
+                wallIdx.push_back(a0);
+                wallIdx.push_back(b0);
+                wallIdx.push_back(b1);
+                wallIdx.push_back(a0);
+                wallIdx.push_back(b1);
+                wallIdx.push_back(a1);
+
+                wMinX = std::min(wMinX, std::min(vA.first, vB.first));
+                wMinY = std::min(wMinY, std::min(vA.second, vB.second));
+                wMinZ = std::min(wMinZ, std::min(bottom + slotTravel(wp.bottomSlot), top + slotTravel(wp.topSlot)));
+                wMaxX = std::max(wMaxX, std::max(vA.first, vB.first));
+                wMaxY = std::max(wMaxY, std::max(vA.second, vB.second));
+                wMaxZ = std::max(wMaxZ, top);
+                if (++wallsInChunk == wallsPerChunk) {
+                    flushWalls();
+                }
+            }
         }
-        size_t addedWall = mesh.indices.size() - wallStart;
-        if (addedWall > 0) {
-            if (mesh.wallIndexCount == 0) mesh.wallIndexStart = wallStart;
-            mesh.wallIndexCount += addedWall;
+        flushWalls();
+    }
+
+    mesh.sectorChunkStart[state.sectors.size()] = static_cast<uint32_t>(mesh.chunks.size());
+
+    // Door slabs: a thin box on each door line from the higher floor to the lower ceiling on
+    // either side, built closed. Each door's vertices are contiguous so opening it only patches
+    // that range; the top face is never seen and is left out.
+    std::vector<uint16_t> doorIdx;
+    const float doorHalfThickness = 0.1f;
+    for (int lineIndex : state.level.doorLines) {
+        MeshDoor door;
+        door.firstVertex = baseIndex;
+        const LineDef& line = state.lines[lineIndex];
+        const auto& a = state.vertices[line.v1];
+        const auto& b = state.vertices[line.v2];
+        const float edgeX = b.first - a.first;
+        const float edgeY = b.second - a.second;
+        const float len = std::sqrt(edgeX * edgeX + edgeY * edgeY);
+        if (len < 0.0001f) {
+            mesh.doors.push_back(door);
+            continue;
         }
+        const float nx = edgeY / len;
+        const float ny = -edgeX / len;
+        const float midX = 0.5f * (a.first + b.first);
+        const float midY = 0.5f * (a.second + b.second);
+        float bottom = -1e30f;
+        float top = 1e30f;
+        for (float side : { -0.05f, 0.05f }) {
+            const int s = findSectorAt(state.level, midX + nx * side, midY + ny * side);
+            if (s < 0)
+                continue;
+            bottom = std::max(bottom, state.sectors[s].floorHeight);
+            top = std::min(top, state.sectors[s].ceilingHeight);
+        }
+        if (bottom > top) {
+            bottom = 0.0f;
+            top = 3.0f;
+        }
+        door.bottom = bottom;
+        door.top = top;
+
+        const float ox = nx * doorHalfThickness;
+        const float oy = ny * doorHalfThickness;
+        // Corners: a/b ends, + and - sides of the line.
+        const float ax0 = a.first + ox, ay0 = a.second + oy;
+        const float bx0 = b.first + ox, by0 = b.second + oy;
+        const float ax1 = a.first - ox, ay1 = a.second - oy;
+        const float bx1 = b.first - ox, by1 = b.second - oy;
+        const float capU = 2.0f * doorHalfThickness / len;
+        auto addSide = [&](float x0, float y0, float x1, float y1, float fx, float fy, float u1) {
+            const uint16_t p0 = addVertex(x0, y0, bottom, fx, fy, 0.0f, 0.6f, 0.6f, 0.6f, 0.0f, 0.0f);
+            const uint16_t p1 = addVertex(x1, y1, bottom, fx, fy, 0.0f, 0.6f, 0.6f, 0.6f, u1, 0.0f);
+            const uint16_t p2 = addVertex(x1, y1, top, fx, fy, 0.0f, 0.6f, 0.6f, 0.6f, u1, 1.0f);
+            const uint16_t p3 = addVertex(x0, y0, top, fx, fy, 0.0f, 0.6f, 0.6f, 0.6f, 0.0f, 1.0f);
+            doorIdx.insert(doorIdx.end(), { p0, p1, p2, p0, p2, p3 });
+        };
+        addSide(ax0, ay0, bx0, by0, nx, ny, 1.0f);
+        addSide(bx1, by1, ax1, ay1, -nx, -ny, 1.0f);
+        addSide(ax1, ay1, ax0, ay0, -edgeX / len, -edgeY / len, capU);
+        addSide(bx0, by0, bx1, by1, edgeX / len, edgeY / len, capU);
+        const uint16_t q0 = addVertex(ax0, ay0, bottom, 0.0f, 0.0f, -1.0f, 0.6f, 0.6f, 0.6f, 0.0f, 0.0f);
+        const uint16_t q1 = addVertex(bx0, by0, bottom, 0.0f, 0.0f, -1.0f, 0.6f, 0.6f, 0.6f, 1.0f, 0.0f);
+        const uint16_t q2 = addVertex(bx1, by1, bottom, 0.0f, 0.0f, -1.0f, 0.6f, 0.6f, 0.6f, 1.0f, capU);
+        const uint16_t q3 = addVertex(ax1, ay1, bottom, 0.0f, 0.0f, -1.0f, 0.6f, 0.6f, 0.6f, 0.0f, capU);
+        doorIdx.insert(doorIdx.end(), { q0, q2, q1, q0, q3, q2 });
+        door.vertexCount = baseIndex - door.firstVertex;
+        mesh.doors.push_back(door);
+    }
+
+    mesh.floorIndexStart = 0;
+    mesh.floorIndexCount = floorIdx.size();
+    mesh.ceilingIndexStart = floorIdx.size();
+    mesh.ceilingIndexCount = ceilIdx.size();
+    mesh.wallIndexStart = floorIdx.size() + ceilIdx.size();
+    mesh.wallIndexCount = wallIdx.size();
+    mesh.doorIndexStart = mesh.wallIndexStart + wallIdx.size();
+    mesh.doorIndexCount = doorIdx.size();
+    mesh.indices.reserve(floorIdx.size() + ceilIdx.size() + wallIdx.size() + doorIdx.size());
+    mesh.indices.insert(mesh.indices.end(), floorIdx.begin(), floorIdx.end());
+    mesh.indices.insert(mesh.indices.end(), ceilIdx.begin(), ceilIdx.end());
+    mesh.indices.insert(mesh.indices.end(), wallIdx.begin(), wallIdx.end());
+    mesh.indices.insert(mesh.indices.end(), doorIdx.begin(), doorIdx.end());
+    for (auto& chunk : mesh.chunks) {
+        chunk.floorStart += static_cast<uint32_t>(mesh.floorIndexStart);
+        chunk.ceilingStart += static_cast<uint32_t>(mesh.ceilingIndexStart);
+        chunk.wallStart += static_cast<uint32_t>(mesh.wallIndexStart);
     }
 
-    std::printf("world mesh: %zu verts, %zu tris\n",
+    std::printf("world mesh: %zu verts, %zu tris, %zu chunks\n",
                 mesh.vertices.size() / 3,
-                mesh.indices.size() / 3);
+                mesh.indices.size() / 3,
+                mesh.chunks.size());
 }
+// Recompiles the level (sector adjacency, portals) and then the mesh that depends on it.
+static void rebuildWorld(EditorState& state) {
+    compileLevel(state, state.level);
+    rebuildWorldMesh(state, state.worldMesh);
+}
+
 static std::vector<std::vector<int>> findClosedLoops(const EditorState& state) {
     std::vector<std::vector<int>> loops;
     if (state.vertices.size() < 3 || state.lines.size() < 3)
@@ -611,8 +742,21 @@ static std::vector<std::vector<int>> findClosedLoops(const EditorState& state) {
 }
 
 int main(int argc, char** argv) {
-    (void)argc;
-    (void)argv;
+    bool singleThreaded = false;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    bool replayFast = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--single-thread") == 0) {
+            singleThreaded = true;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay-fast") == 0) {
+            replayFast = true;
+        }
+    }
 
     if (!PlatformInit()) {
         std::printf("PlatformInit failed\n");
@@ -682,6 +826,16 @@ int main(int argc, char** argv) {
 
     SDL_GL_SetSwapInterval(1); // vsync
 
+    FramePacer pacer;
+#ifndef __EMSCRIPTEN__
+    // Pace to the display refresh; the browser build is already paced by requestAnimationFrame.
+    int refreshHz = 60;
+    SDL_DisplayMode displayMode;
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &displayMode) == 0 && displayMode.refresh_rate > 0)
+        refreshHz = displayMode.refresh_rate;
+    pacer.setTargetPeriodNs(1000000000ull / static_cast<uint64_t>(refreshHz));
+#endif
+
     RendererGL renderer;
     if (!renderer.init(window)) {
         printf("Renderer init failed\n");
@@ -726,23 +880,54 @@ int main(int argc, char** argv) {
     state.cursorRawY = 3.0f;
     state.cursorX    = 4.0f;
     state.cursorY    = 3.0f;
-    rebuildWorldMesh(state, state.worldMesh);
+    rebuildWorld(state);
     Camera3D fpsCamera;
+    // Play mode runs fixed ticks; prevCamera is the pose before the latest one.
+    Camera3D prevCamera;
+    PlayInput playInput;
+    float playAccumulator = 0.0f;
     std::string dataPath = PlatformDataPath();
     // Use the higher-detail panels/lights for walls/floors so they are visible in all builds.
-    GLuint texWall = loadTextureFromPNG((dataPath + "wall.png").c_str());
-    GLuint texFloor = loadTextureFromPNG((dataPath + "floor.png").c_str());
-    GLuint texCeil = loadTextureFromPNG((dataPath + "ceiling.png").c_str());
-    renderer.setTextures(texFloor, texWall, texCeil);
-    GLuint texEnemySprite = loadTextureFromPNG((dataPath + "enemy_wizard.png").c_str());
-    GLuint texProjSprite = loadTextureFromPNG((dataPath + "projectile_orb.png").c_str());
-    GLuint texItemHealth = loadTextureFromPNG((dataPath + "item_health.png").c_str());
-    GLuint texBlockFlash = loadTextureFromPNG((dataPath + "block_flash.png").c_str());
-    GLuint texDoorSprite = loadTextureFromPNG((dataPath + "metal_door.png").c_str());
+    const char* const textureFiles[] = {
+        "wall.png", "floor.png", "ceiling.png", "enemy_wizard.png", "projectile_orb.png",
+        "item_health.png", "block_flash.png", "metal_door.png",
+    };
+    constexpr size_t textureCount = sizeof(textureFiles) / sizeof(textureFiles[0]);
+    std::string texturePaths[textureCount];
+    const char* texturePathPtrs[textureCount];
+    for (size_t i = 0; i < textureCount; ++i) {
+        texturePaths[i] = dataPath + textureFiles[i];
+        texturePathPtrs[i] = texturePaths[i].c_str();
+    }
+    GLuint textures[textureCount];
+    loadTexturesFromPNG(texturePathPtrs, textureCount, textures);
+    GLuint texWall = textures[0];
+    GLuint texFloor = textures[1];
+    GLuint texCeil = textures[2];
+    GLuint texDoor = textures[7];
+    renderer.setTextures(texFloor, texWall, texCeil, texDoor);
+    GLuint texEnemySprite = textures[3];
+    GLuint texProjSprite = textures[4];
+    GLuint texItemHealth = textures[5];
+    GLuint texBlockFlash = textures[6];
     renderer.setBillboardTextures(texEnemySprite, texProjSprite);
     // Use the health pickup art for both until the mana asset is fixed.
     renderer.setItemTextures(texItemHealth, texItemHealth);
     renderer.setEffectTextures(texBlockFlash);
+    // All GL resources exist now, so the context can move to the render thread.
+    if (!singleThreaded) {
+        renderer.startRenderThread(window, glCtx);
+    }
+
+    // --record writes each play session to a file; --replay feeds one back through playTick.
+    ReplayRecorder recorder;
+    ReplayReader replay;
+    bool replaying = false;
+    std::vector<float> replayFrameMs;
+    // Play checkpoints. A hit rewinds to one instead of ending the session, except while a
+    // session is being recorded or replayed: those have to stay one unbroken run.
+    SnapshotRing checkpoints;
+    checkpoints.reserve(kSnapshotArenaBytes);
 
     auto enterPlayMode = [&]() {
         if (state.playMode)
@@ -753,43 +938,15 @@ int main(int argc, char** argv) {
         state.hoveredVertex = -1;
         state.selectedEntity = -1;
         state.hoveredEntity = -1;
-        fpsCamera = Camera3D{};
-        bool foundStart = false;
-        for (const auto& e : state.entities) {
-            if (e.type == EntityType::PlayerStart) {
-                fpsCamera.x = e.x;
-                fpsCamera.y = e.y;
-                fpsCamera.z = 1.7f;
-                foundStart = true;
-                break;
-            }
-        }
-        if (!foundStart) {
-            fpsCamera.x = 4.0f;
-            fpsCamera.y = 3.0f;
-            fpsCamera.z = 1.7f;
+        playBegin(state, fpsCamera);
+        if (recordPath && !replaying) {
+            recorder.begin(state, fpsCamera);
         }
-        state.enemies.clear();
-        for (const auto& e : state.entities) {
-            if (e.type == EntityType::EnemyWizard) {
-                state.enemies.push_back({ e.x, e.y, 1.4f, 0.0f, true });
-            }
-        }
-        state.items.clear();
-        for (const auto& e : state.entities) {
-            if (e.type == EntityType::ItemPickup) {
-                state.items.push_back({ e.x, e.y, 1.0f, e.type, true });
-            }
-        }
-        state.doors.clear();
-        for (const auto& e : state.entities) {
-            if (e.type == EntityType::Door) {
-                state.doors.push_back({ e.x, e.y, 2.0f, 3.0f, 0.0f, false, false, true });
-            }
-        }
-        state.projectiles.active.clear();
-        state.blocking = false;
-        state.blockFlashTimer = 0.0f;
+        checkpoints.clear();
+        checkpoints.capture(state, fpsCamera);
+        prevCamera = fpsCamera;
+        playInput = PlayInput{};
+        playAccumulator = 0.0f;
 #ifndef __SWITCH__
     #ifdef __EMSCRIPTEN__
         SDL_SetRelativeMouseMode(SDL_TRUE);
@@ -802,12 +959,32 @@ int main(int argc, char** argv) {
     auto exitPlayMode = [&]() {
         if (!state.playMode)
             return;
+        if (recorder.active()) {
+            recorder.finish(recordPath);
+        }
+        if (replaying) {
+            std::printf("replay: stopped at tick %u of %u\n", replay.ticksRead(), replay.tickCount());
+            replaying = false;
+        }
         state.playMode = false;
         state.blocking = false;
         state.blockFlashTimer = 0.0f;
-        state.projectiles.active.clear();
+        state.projectiles.clear();
         state.enemies.clear();
+        state.freeEnemies.clear();
+        state.spawners.clear();
+        state.ai.clear();
+        state.enemyHash.clear();
+        state.sight.clear();
         state.doors.clear();
+        state.activeDoors.clear();
+        // Back to the heights the editor shows.
+        for (size_t m = 0; m < state.movers.size(); ++m)
+            setMoverOffset(state.level, static_cast<int>(m), 0.0f);
+        state.movers.clear();
+        state.triggers.clear();
+        state.blockmap.clear();
+        state.flow.clear();
         fpsCamera = Camera3D{};
 #ifndef __SWITCH__
     #ifdef __EMSCRIPTEN__
@@ -818,18 +995,128 @@ int main(int argc, char** argv) {
 #endif
     };
 
+    // Puts play back kRewindTicks, or to the oldest checkpoint left.
+    auto rewindPlay = [&]() {
+        if (!state.playMode || replaying || recorder.active())
+            return false;
+        const uint32_t tick = state.ai.tick();
+        if (!checkpoints.restore(state, fpsCamera, tick > kRewindTicks ? tick - kRewindTicks : 0))
+            return false;
+        prevCamera = fpsCamera;
+        playInput.yaw = fpsCamera.yaw;
+        playInput.pitch = fpsCamera.pitch;
+        const SnapshotStats& snap = checkpoints.stats();
+        std::printf("Rewound %.1f s (%zu byte checkpoint restored in %.1f us)\n",
+                    (tick - state.ai.tick()) / kPlayTickRate, snap.lastBytes, snap.lastRestoreNs * 1e-3);
+        return true;
+    };
+
     bool running = true;
+
+    if (replayPath) {
+        if (replay.load(replayPath, state)) {
+            rebuildWorld(state);
+            replaying = true;
+            enterPlayMode();
+            fpsCamera = replay.startPose();
+            prevCamera = fpsCamera;
+            if (replayFast) {
+                // One tick per frame, as fast as the GPU allows.
+                SDL_GL_SetSwapInterval(0);
+                pacer.setTargetPeriodNs(0);
+            }
+        } else {
+            std::printf("replay: falling back to the editor\n");
+        }
+    }
+
+    auto finishReplay = [&]() {
+        const uint64_t hash = hashPlayState(state, fpsCamera);
+        const bool complete = replay.ticksRead() == replay.tickCount();
+        std::printf("replay: %u/%u ticks, state hash %016llx, recorded %016llx: %s\n",
+                    replay.ticksRead(), replay.tickCount(),
+                    static_cast<unsigned long long>(hash),
+                    static_cast<unsigned long long>(replay.expectedHash()),
+                    complete && hash == replay.expectedHash() ? "match" : "DIVERGED");
+        if (!replayFrameMs.empty()) {
+            std::vector<float> sorted = replayFrameMs;
+            std::sort(sorted.begin(), sorted.end());
+            double total = 0.0;
+            for (float ms : sorted) total += ms;
+            auto pct = [&](double p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1))]; };
+            std::printf("replay: %zu frames, avg %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+                        sorted.size(), total / sorted.size(), pct(0.5), pct(0.95), pct(0.99), sorted.back());
+        }
+        replaying = false;
+        exitPlayMode();
+        running = false;
+    };
+
     bool fullscreen = (windowFlags & SDL_WINDOW_FULLSCREEN) != 0;
     bool shiftHeld = false;
     int mouseX = 0;
     int mouseY = 0;
-    uint64_t lastTicks = PlatformTicks();
+    uint64_t lastFrameNs = PlatformTimeNs();
     std::vector<int> loopHighlight;
     float loopHighlightTimer = 0.0f;
+    bool printCullStats = false;
+    float cullStatsTimer = 0.0f;
+    // Input-to-swap latency of play frames since the last stats print.
+    uint64_t latencySumNs = 0;
+    uint64_t latencyMaxNs = 0;
+    unsigned latencySamples = 0;
+    size_t sectorsVisible = 0;
+    std::vector<uint8_t> visibleSectors;
+    std::vector<uint8_t> sectorScratch;
+    std::vector<int> sectorOrder;
+    std::vector<float> doorProgress;
+
+    // Look is sampled right before the 3D draws instead of with the rest of the input, so the
+    // swapped frame shows the newest mouse and stick state. Ticks pick it up as playInput next frame.
+    auto latchLook = [&](float dt) {
+        SDL_PumpEvents();
+        const Uint8* keys = SDL_GetKeyboardState(nullptr);
+        const int16_t deadZone = 8000;
+        const float invMax = 1.0f / 32767.0f;
+        float lookX = 0.0f, lookY = 0.0f;
+        if (controller) {
+            int16_t lookXRaw = SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_RIGHTX);
+            int16_t lookYRaw = SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_RIGHTY);
+            lookX += (std::abs(lookXRaw) > deadZone) ? lookXRaw * invMax : 0.0f;
+            lookY += (std::abs(lookYRaw) > deadZone) ? lookYRaw * invMax : 0.0f;
+        }
+        if (keys[SDL_SCANCODE_Q]) lookX -= 1.0f; // turn left
+        if (keys[SDL_SCANCODE_E]) lookX += 1.0f; // turn right
+
+        int relX = 0, relY = 0;
+        SDL_GetRelativeMouseState(&relX, &relY);
+        const float mouseSensitivity = 0.0025f; // radians per pixel
+        float mouseYawDelta = 0.0f;
+        float mousePitchDelta = 0.0f;
+#if defined(__EMSCRIPTEN__)
+        // Browser pointer lock already matches expected desktop sign.
+        mouseYawDelta   += static_cast<float>(relX) * mouseSensitivity;
+        mousePitchDelta -= static_cast<float>(relY) * mouseSensitivity;
+#else
+        // Native desktop needs inverted X/Y after SDL coordinate handling changes.
+        mouseYawDelta   -= static_cast<float>(relX) * mouseSensitivity;
+        mousePitchDelta += static_cast<float>(relY) * mouseSensitivity;
+#endif
+
+        const float lookSpeed = 2.5f;
+        // Controller/QE look is frame-rate independent; mouse deltas apply directly.
+        fpsCamera.yaw   += (lookX * lookSpeed * dt) + mouseYawDelta;
+        fpsCamera.pitch -= (lookY * lookSpeed * dt) + mousePitchDelta;
+        if (fpsCamera.pitch > 1.2f) fpsCamera.pitch = 1.2f;
+        if (fpsCamera.pitch < -1.2f) fpsCamera.pitch = -1.2f;
+        playInput.yaw = fpsCamera.yaw;
+        playInput.pitch = fpsCamera.pitch;
+        renderer.markInputSampled(PlatformTimeNs());
+    };
 
     // Main loop; PlatformRunning handles Switch appletMainLoop or desktop quit events
     auto frame = [&]() {
-        if (!PlatformRunning()) {
+        if (!running || !PlatformRunning()) {
             running = false;
 #ifdef __EMSCRIPTEN__
             emscripten_cancel_main_loop();
@@ -837,9 +1124,9 @@ int main(int argc, char** argv) {
             return;
         }
 
-        uint64_t now = PlatformTicks();
-        float dt = static_cast<float>(now - lastTicks) / 1000.0f;
-        lastTicks = now;
+        const uint64_t now = pacer.beginFrame();
+        float dt = static_cast<float>(now - lastFrameNs) * 1e-9f;
+        lastFrameNs = now;
         if (loopHighlightTimer > 0.0f) {
             loopHighlightTimer -= dt;
             if (loopHighlightTimer < 0.0f) {
@@ -855,6 +1142,11 @@ int main(int argc, char** argv) {
         bool deletePressed = false;
         bool createSectorPressed = false;
         bool togglePlayPressed = false;
+        bool rewindPressed = false;
+        float floorNudge = 0.0f;   // height edits for the sector under the cursor
+        float ceilingNudge = 0.0f;
+        float intervalNudge = 0.0f; // seconds between waves of the selected spawner
+        bool cycleMoverPressed = false;
         bool needRebuild = false;
         bool mouseFire = false;
         bool mouseBlock = false;
@@ -915,7 +1207,8 @@ int main(int argc, char** argv) {
                         deletePressed = true;
                     }
                     if (ev.cbutton.button == SDL_CONTROLLER_BUTTON_Y) {
-                        createSectorPressed = true;
+                        if (state.playMode) rewindPressed = true;
+                        else createSectorPressed = true;
                     }
                     if (ev.cbutton.button == SDL_CONTROLLER_BUTTON_BACK) {
                         togglePlayPressed = true;
@@ -933,6 +1226,12 @@ int main(int argc, char** argv) {
                         state.selectedEntity = -1;
                         state.hoveredEntity = -1;
                     }
+                    if (ev.cbutton.button == SDL_CONTROLLER_BUTTON_DPAD_LEFT) {
+                        floorNudge -= 0.25f;
+                    }
+                    if (ev.cbutton.button == SDL_CONTROLLER_BUTTON_DPAD_RIGHT) {
+                        floorNudge += 0.25f;
+                    }
                     break;
                 case SDL_CONTROLLERDEVICEADDED:
                     tryOpenController();
@@ -963,6 +1262,22 @@ int main(int argc, char** argv) {
                         SDL_SetWindowFullscreen(window, fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0);
                         break;
                     }
+                    if (ev.key.keysym.sym == SDLK_F8 && ev.key.repeat == 0) {
+                        printCullStats = !printCullStats;
+                        cullStatsTimer = 0.0f;
+                        latencySumNs = 0;
+                        latencyMaxNs = 0;
+                        latencySamples = 0;
+                    }
+                    if (ev.key.keysym.sym == SDLK_BACKSPACE && state.playMode) {
+                        rewindPressed = true;
+                    }
+                    if (ev.key.keysym.sym == SDLK_F9 && ev.key.repeat == 0) {
+                        renderer.captureNextFrame();
+                    }
+                    if (ev.key.keysym.sym == SDLK_F10 && ev.key.repeat == 0) {
+                        renderer.replayLastFrame(100);
+                    }
                     if (ev.key.keysym.sym == SDLK_TAB && ev.key.repeat == 0) {
                         if (state.playMode) exitPlayMode();
                         else enterPlayMode();
@@ -1033,6 +1348,17 @@ int main(int argc, char** argv) {
                             createSectorPressed = true;
                         }
                     }
+                    if (ev.key.keysym.sym == SDLK_PAGEUP || ev.key.keysym.sym == SDLK_PAGEDOWN) {
+                        const float step = ev.key.keysym.sym == SDLK_PAGEUP ? 0.25f : -0.25f;
+                        if (ev.key.keysym.mod & KMOD_SHIFT) ceilingNudge += step;
+                        else floorNudge += step;
+                    }
+                    if (ev.key.keysym.sym == SDLK_LEFTBRACKET || ev.key.keysym.sym == SDLK_RIGHTBRACKET) {
+                        intervalNudge += ev.key.keysym.sym == SDLK_RIGHTBRACKET ? 0.5f : -0.5f;
+                    }
+                    if (ev.key.keysym.sym == SDLK_m && ev.key.repeat == 0) {
+                        cycleMoverPressed = true;
+                    }
 #endif
                     break;
                 case SDL_KEYUP:
@@ -1129,6 +1455,8 @@ int main(int argc, char** argv) {
             if (state.playMode) exitPlayMode();
             else enterPlayMode();
         }
+        if (rewindPressed)
+            rewindPlay();
 
 #ifndef __SWITCH__
         // Ensure mouse grab matches play/edit state on desktop
@@ -1232,22 +1560,19 @@ int main(int argc, char** argv) {
             }
         }
 
-        if (state.playMode) {
+        uint64_t simNs = 0;
+        if (state.playMode && !replaying) {
             const int16_t deadZone = 8000;
             const float invMax = 1.0f / 32767.0f;
-            float moveX = 0.0f, moveY = 0.0f, lookX = 0.0f, lookY = 0.0f;
+            float moveX = 0.0f, moveY = 0.0f;
             bool controllerBlock = false;
 
             if (controller) {
                 int16_t moveXRaw = SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_LEFTX);
                 int16_t moveYRaw = SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_LEFTY);
-                int16_t lookXRaw = SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_RIGHTX);
-                int16_t lookYRaw = SDL_GameControllerGetAxis(controller, SDL_CONTROLLER_AXIS_RIGHTY);
 
                 moveX += (std::abs(moveXRaw) > deadZone) ? moveXRaw * invMax : 0.0f;
                 moveY += (std::abs(moveYRaw) > deadZone) ? moveYRaw * invMax : 0.0f;
-                lookX += (std::abs(lookXRaw) > deadZone) ? lookXRaw * invMax : 0.0f;
-                lookY += (std::abs(lookYRaw) > deadZone) ? lookYRaw * invMax : 0.0f;
                 controllerBlock = SDL_GameControllerGetButton(controller, SDL_CONTROLLER_BUTTON_LEFTSHOULDER);
             }
 
@@ -1255,250 +1580,54 @@ int main(int argc, char** argv) {
             if (keys[SDL_SCANCODE_D]) moveX += 1.0f;
             if (keys[SDL_SCANCODE_W]) moveY -= 1.0f;
             if (keys[SDL_SCANCODE_S]) moveY += 1.0f;
-            if (keys[SDL_SCANCODE_Q]) lookX -= 1.0f; // turn left
-            if (keys[SDL_SCANCODE_E]) lookX += 1.0f; // turn right
-
-            int relX = 0, relY = 0;
-            SDL_GetRelativeMouseState(&relX, &relY);
-            const float mouseSensitivity = 0.0025f; // radians per pixel
-            float mouseYawDelta = 0.0f;
-            float mousePitchDelta = 0.0f;
-#if defined(__EMSCRIPTEN__)
-            // Browser pointer lock already matches expected desktop sign.
-            mouseYawDelta   += static_cast<float>(relX) * mouseSensitivity;
-            mousePitchDelta -= static_cast<float>(relY) * mouseSensitivity;
-#else
-            // Native desktop needs inverted X/Y after SDL coordinate handling changes.
-            mouseYawDelta   -= static_cast<float>(relX) * mouseSensitivity;
-            mousePitchDelta += static_cast<float>(relY) * mouseSensitivity;
-#endif
 
             bool blockKey = keys[SDL_SCANCODE_SPACE];
-            state.blocking = controllerBlock || blockKey || mouseBlock;
-
-            const float moveSpeed = 5.0f;
-            const float lookSpeed = 2.5f;
-
-            // Controller/QE look is frame-rate independent; mouse deltas apply directly.
-            fpsCamera.yaw   += (lookX * lookSpeed * dt) + mouseYawDelta;
-            fpsCamera.pitch -= (lookY * lookSpeed * dt) + mousePitchDelta;
-            if (fpsCamera.pitch > 1.2f) fpsCamera.pitch = 1.2f;
-            if (fpsCamera.pitch < -1.2f) fpsCamera.pitch = -1.2f;
-
-            const float forwardX = std::sin(fpsCamera.yaw);
-            const float forwardY = std::cos(fpsCamera.yaw);
-            const float rightX = std::cos(fpsCamera.yaw);
-            const float rightY = -std::sin(fpsCamera.yaw);
-
-            float moveForward = -moveY;
-            float moveStrafe = moveX;
-
-            float newX = fpsCamera.x;
-            float newY = fpsCamera.y;
-            if (!state.blocking) {
-                newX += (forwardX * moveForward + rightX * moveStrafe) * moveSpeed * dt;
-                newY += (forwardY * moveForward + rightY * moveStrafe) * moveSpeed * dt;
-            }
-
-            // Update doors (auto-open and animate)
-            for (auto& d : state.doors) {
-                float dx = fpsCamera.x - d.x;
-                float dy = fpsCamera.y - d.y;
-                float dist = std::sqrt(dx * dx + dy * dy);
-                if (!d.locked && dist < 2.0f) d.opening = true;
-                if (d.opening && d.progress < 1.0f) {
-                    d.progress += dt * 1.5f;
-                    if (d.progress > 1.0f) d.progress = 1.0f;
-                }
-            }
-
-            if (mouseFire) {
-                const float projSpeed = 6.0f;
-                spawnProjectile(state, fpsCamera.x, fpsCamera.y, fpsCamera.z,
-                                forwardX * projSpeed, forwardY * projSpeed, 0.0f, true);
-            }
-
-            const float radius = fpsCamera.radius;
-            for (const auto& line : state.lines) {
-                if (line.v1 < 0 || line.v2 < 0 ||
-                    line.v1 >= static_cast<int>(state.vertices.size()) ||
-                    line.v2 >= static_cast<int>(state.vertices.size())) {
-                    continue;
-                }
-                const auto& a = state.vertices[line.v1];
-                const auto& b = state.vertices[line.v2];
-                Vec2 nearest = closestPointOnSegment(newX, newY, a.first, a.second, b.first, b.second);
-                float dist = distance2D(newX, newY, nearest.x, nearest.y);
-                if (dist < radius && dist > 0.0001f) {
-                    float dx = newX - nearest.x;
-                    float dy = newY - nearest.y;
-                    float len = std::sqrt(dx * dx + dy * dy);
-                    dx /= len;
-                    dy /= len;
-                    newX = nearest.x + dx * radius;
-                    newY = nearest.y + dy * radius;
-                }
-            }
-
-            // Door collision when not fully open
-            for (const auto& d : state.doors) {
-                if (!d.active) continue;
-                if (d.progress >= 1.0f) continue;
-                float dx = newX - d.x;
-                float dy = newY - d.y;
-                float dist = std::sqrt(dx * dx + dy * dy);
-                float blockR = d.width * 0.6f + radius;
-                if (dist < blockR && dist > 0.0001f) {
-                    dx /= dist; dy /= dist;
-                    newX = d.x + dx * blockR;
-                    newY = d.y + dy * blockR;
-                }
-            }
 
-            fpsCamera.x = newX;
-            fpsCamera.y = newY;
-            fpsCamera.z = std::clamp(fpsCamera.z, 0.0f + 1.6f, 3.0f - 0.1f);
+            playInput.moveX = moveX;
+            playInput.moveY = moveY;
+            playInput.block = controllerBlock || blockKey || mouseBlock;
+            // A click stays latched until a tick consumes it, even on frames that run no tick.
+            playInput.fire = playInput.fire || mouseFire;
         }
 
+        int ticks = 0;
         if (state.playMode) {
-            // Enemy AI
-            for (auto& e : state.enemies) {
-                if (!e.alive) continue;
-                e.cooldown -= dt;
-                if (e.cooldown <= 0.0f) {
-                    float dx = fpsCamera.x - e.x;
-                    float dy = fpsCamera.y - e.y;
-                    float len = std::sqrt(dx * dx + dy * dy);
-                    if (len > 0.0001f) {
-                        dx /= len;
-                        dy /= len;
-                        spawnProjectile(state, e.x, e.y, e.z, dx * 4.0f, dy * 4.0f, 0.0f, false);
-                    }
-                    e.cooldown = 2.0f;
-                }
-            }
-
-            // Projectiles
-            const float projectileRadius = 0.12f;
-            for (auto& p : state.projectiles.active) {
-                if (!p.alive) continue;
-                p.x += p.vx * dt;
-                p.y += p.vy * dt;
-                p.z += p.vz * dt;
-
-                // wall collision
-                for (const auto& line : state.lines) {
-                    if (line.v1 < 0 || line.v2 < 0 ||
-                        line.v1 >= static_cast<int>(state.vertices.size()) ||
-                        line.v2 >= static_cast<int>(state.vertices.size())) {
-                        continue;
-                    }
-                    const auto& a = state.vertices[line.v1];
-                    const auto& b = state.vertices[line.v2];
-                    Vec2 nearest = closestPointOnSegment(p.x, p.y, a.first, a.second, b.first, b.second);
-                    float dist = distance2D(p.x, p.y, nearest.x, nearest.y);
-                    if (dist < projectileRadius) {
-                        float nx = b.second - a.second;
-                        float ny = -(b.first - a.first);
-                        float nlen = std::sqrt(nx * nx + ny * ny);
-                        if (nlen > 0.0001f) {
-                            nx /= nlen; ny /= nlen;
-                        } else {
-                            nx = 0.0f; ny = 1.0f;
-                        }
-                        if (p.fromPlayer || state.blocking) {
-                            p.fromPlayer = true;
-                            float dot = p.vx * nx + p.vy * ny;
-                            p.vx = p.vx - 2.0f * dot * nx;
-                            p.vy = p.vy - 2.0f * dot * ny;
-                            float push = projectileRadius - dist;
-                            p.x += nx * push;
-                            p.y += ny * push;
-                        } else {
-                            p.alive = false;
-                        }
+            const uint64_t simStartNs = PlatformTimeNs();
+            playAccumulator = (replaying && replayFast) ? kPlayTickDt : playAccumulator + dt;
+            while (playAccumulator >= kPlayTickDt && ticks < kPlayMaxCatchUpTicks) {
+                prevCamera = fpsCamera;
+                if (replaying) {
+                    if (!replay.next(playInput)) {
+                        finishReplay();
                         break;
                     }
+                } else if (recorder.active()) {
+                    recorder.record(playInput);
                 }
-
-                if (!p.alive) continue;
-
-                // door collision (block until nearly open)
-                for (const auto& d : state.doors) {
-                    if (!d.active) continue;
-                    if (d.progress >= 0.9f) continue;
-                    float dx = p.x - d.x;
-                    float dy = p.y - d.y;
-                    float dist = std::sqrt(dx * dx + dy * dy);
-                    float blockR = d.width * 0.6f + projectileRadius;
-                    if (dist < blockR) {
-                        p.alive = false;
+                PlayTickResult result = playTick(state, fpsCamera, playInput, kPlayTickDt);
+                recorder.recorded(state, fpsCamera);
+                playInput.fire = false;
+                playAccumulator -= kPlayTickDt;
+                ++ticks;
+                if (result == PlayTickResult::PlayerKilled) {
+                    // finishReplay leaves play mode itself.
+                    if (replaying) {
+                        finishReplay();
                         break;
                     }
-                }
-
-                if (!p.alive) continue;
-
-                // hit player
-                float dp = distance2D(p.x, p.y, fpsCamera.x, fpsCamera.y);
-                if (dp < projectileRadius + fpsCamera.radius) {
-                    if (state.blocking) {
-                        p.fromPlayer = true;
-                        float nx = (p.x - fpsCamera.x);
-                        float ny = (p.y - fpsCamera.y);
-                        float nlen = std::sqrt(nx * nx + ny * ny);
-                        if (nlen > 0.0001f) { nx /= nlen; ny /= nlen; }
-                        float dot = p.vx * nx + p.vy * ny;
-                        p.vx = (p.vx - 2.0f * dot * nx) * 1.2f;
-                        p.vy = (p.vy - 2.0f * dot * ny) * 1.2f;
-                        p.vz = -p.vz * 1.2f;
-                        float push = (projectileRadius + fpsCamera.radius) - dp;
-                        p.x += nx * push;
-                        p.y += ny * push;
-                        state.blockFlashTimer = 0.25f;
-                    } else {
-                        std::printf("Player hit! Returning to editor.\n");
-                        state.playMode = false;
-                        state.projectiles.active.clear();
-                        state.enemies.clear();
-                        state.blocking = false;
+                    if (rewindPlay())
                         break;
-                    }
-                }
-
-                // hit enemy
-                if (p.fromPlayer) {
-                    for (auto& e : state.enemies) {
-                        if (!e.alive) continue;
-                        float de = distance2D(p.x, p.y, e.x, e.y);
-                        if (de < projectileRadius + 0.25f) {
-                            e.alive = false;
-                            p.alive = false;
-                            break;
-                        }
-                    }
-                }
-            }
-
-            state.projectiles.active.erase(
-                std::remove_if(state.projectiles.active.begin(), state.projectiles.active.end(),
-                               [](const Projectile& p) { return !p.alive; }),
-                state.projectiles.active.end());
-            state.enemies.erase(
-                std::remove_if(state.enemies.begin(), state.enemies.end(),
-                               [](const EnemyWizard& e) { return !e.alive; }),
-                state.enemies.end());
-            for (auto& it : state.items) {
-                if (!it.alive) continue;
-                float d = distance2D(fpsCamera.x, fpsCamera.y, it.x, it.y);
-                if (d < 0.6f) {
-                    it.alive = false;
-                    std::printf("Picked up item!\n");
+                    std::printf("Returning to editor.\n");
+                    exitPlayMode();
+                    break;
                 }
+                if (state.ai.tick() % kSnapshotIntervalTicks == 0)
+                    checkpoints.capture(state, fpsCamera);
             }
-            if (state.blockFlashTimer > 0.0f) {
-                state.blockFlashTimer -= dt;
-                if (state.blockFlashTimer < 0.0f) state.blockFlashTimer = 0.0f;
+            simNs = PlatformTimeNs() - simStartNs;
+            if (playAccumulator >= kPlayTickDt) {
+                // Too far behind; drop the backlog rather than spiral.
+                playAccumulator = std::fmod(playAccumulator, kPlayTickDt);
             }
         }
 
@@ -1566,7 +1695,16 @@ int main(int argc, char** argv) {
 
         int placedVertexIndex = -1;
         if (!state.playMode && placePressed) {
-            if (state.entityMode) {
+            if (state.entityMode && state.entityBrush == EntityType::Door) {
+                // Doors live on lines: toggle the flag on the line under the cursor.
+                const int doorLine = findLineAt(state, state.cursorX, state.cursorY);
+                if (doorLine != -1) {
+                    LineDef& line = state.lines[doorLine];
+                    line.door = !line.door;
+                    std::printf("Line %d door %s\n", doorLine, line.door ? "on" : "off");
+                    needRebuild = true;
+                }
+            } else if (state.entityMode) {
                 Entity newEnt;
                 newEnt.x = state.cursorX;
                 newEnt.y = state.cursorY;
@@ -1660,15 +1798,57 @@ int main(int argc, char** argv) {
                     s.clockwise = (area < 0.0f);
                     state.sectors.push_back(std::move(s));
                 }
-                rebuildWorldMesh(state, state.worldMesh);
+                rebuildWorld(state);
                 needRebuild = false;
             }
         }
 
+        // With a spawner selected the height keys tune it instead: floor for the wave size,
+        // ceiling for the cap, and [/] for the seconds between waves.
+        if (!state.playMode && state.entityMode && state.selectedEntity >= 0 &&
+            state.selectedEntity < static_cast<int>(state.entities.size()) &&
+            state.entities[state.selectedEntity].type == EntityType::Spawner &&
+            (floorNudge != 0.0f || ceilingNudge != 0.0f || intervalNudge != 0.0f)) {
+            Entity& spawner = state.entities[state.selectedEntity];
+            const int waveStep = floorNudge > 0.0f ? 1 : (floorNudge < 0.0f ? -1 : 0);
+            const int capStep = ceilingNudge > 0.0f ? 8 : (ceilingNudge < 0.0f ? -8 : 0);
+            spawner.waveSize = static_cast<uint16_t>(std::clamp(spawner.waveSize + waveStep, 1, static_cast<int>(kMaxSpawnerWave)));
+            spawner.waveCap = static_cast<uint16_t>(std::clamp(spawner.waveCap + capStep, static_cast<int>(spawner.waveSize),
+                                                               static_cast<int>(kMaxSpawnerCap)));
+            spawner.waveInterval = std::clamp(spawner.waveInterval + intervalNudge, kMinSpawnerInterval, kMaxSpawnerInterval);
+            std::printf("Spawner %d: %u per wave every %.1f s, at most %u alive\n", state.selectedEntity,
+                        static_cast<unsigned>(spawner.waveSize), spawner.waveInterval,
+                        static_cast<unsigned>(spawner.waveCap));
+            floorNudge = 0.0f;
+            ceilingNudge = 0.0f;
+        }
+        if (!state.playMode && (floorNudge != 0.0f || ceilingNudge != 0.0f)) {
+            const int s = findSectorAt(state.level, state.cursorX, state.cursorY);
+            if (s >= 0) {
+                Sector& sector = state.sectors[s];
+                // Keep at least a crouch's worth of room between floor and ceiling.
+                const float minGap = 0.5f;
+                sector.floorHeight = std::min(sector.floorHeight + floorNudge, sector.ceilingHeight - minGap);
+                sector.ceilingHeight = std::max(sector.ceilingHeight + ceilingNudge, sector.floorHeight + minGap);
+                std::printf("Sector %d: floor %.2f, ceiling %.2f\n", s, sector.floorHeight, sector.ceilingHeight);
+                needRebuild = true;
+            }
+        }
+        if (!state.playMode && cycleMoverPressed) {
+            const int s = findSectorAt(state.level, state.cursorX, state.cursorY);
+            if (s >= 0) {
+                static const char* const moverNames[] = { "none", "door", "lift" };
+                Sector& sector = state.sectors[s];
+                sector.mover = static_cast<SectorMover>((static_cast<int>(sector.mover) + 1) % 3);
+                std::printf("Sector %d: mover %s\n", s, moverNames[static_cast<int>(sector.mover)]);
+                needRebuild = true;
+            }
+        }
+
         if (!state.playMode) {
             renderer.setCamera(camera);
             if (needRebuild) {
-                rebuildWorldMesh(state, state.worldMesh);
+                rebuildWorld(state);
                 needRebuild = false;
             }
 
@@ -1701,7 +1881,10 @@ int main(int argc, char** argv) {
                 }
                 const auto& v1 = state.vertices[line.v1];
                 const auto& v2 = state.vertices[line.v2];
-                renderer.drawLine2D(v1.first, v1.second, v2.first, v2.second, 1.0f, 1.0f, 1.0f);
+                if (line.door)
+                    renderer.drawLine2D(v1.first, v1.second, v2.first, v2.second, 0.9f, 0.8f, 0.1f);
+                else
+                    renderer.drawLine2D(v1.first, v1.second, v2.first, v2.second, 1.0f, 1.0f, 1.0f);
             }
 
             if (!loopHighlight.empty() && loopHighlightTimer > 0.0f) {
@@ -1736,6 +1919,7 @@ int main(int argc, char** argv) {
                     case EntityType::EnemyWizard: r = 0.7f; g = 0.2f; b = 0.9f; break;
                     case EntityType::ItemPickup:  r = 1.0f; g = 0.5f; b = 0.1f; break;
                     case EntityType::Door:        r = 0.6f; g = 0.6f; b = 0.0f; break;
+                    case EntityType::Spawner:     r = 0.9f; g = 0.1f; b = 0.3f; break;
                 }
                 if (selected) { r = 1.0f; g = 0.5f; b = 0.0f; size *= 1.1f; }
                 else if (hovered) { r = 1.0f; g = 1.0f; b = 0.0f; size *= 1.05f; }
@@ -1765,6 +1949,16 @@ int main(int argc, char** argv) {
                         renderer.drawLine2D(e.x - size, e.y + size, e.x - size, e.y - size, r, g, b);
                         break;
                     }
+                    case EntityType::Spawner: {
+                        // A wizard's diamond with a cross through it.
+                        renderer.drawLine2D(e.x - size, e.y, e.x, e.y + size, r, g, b);
+                        renderer.drawLine2D(e.x, e.y + size, e.x + size, e.y, r, g, b);
+                        renderer.drawLine2D(e.x + size, e.y, e.x, e.y - size, r, g, b);
+                        renderer.drawLine2D(e.x, e.y - size, e.x - size, e.y, r, g, b);
+                        renderer.drawLine2D(e.x - size, e.y, e.x + size, e.y, r, g, b);
+                        renderer.drawLine2D(e.x, e.y - size, e.x, e.y + size, r, g, b);
+                        break;
+                    }
                 }
             };
 
@@ -1780,6 +1974,7 @@ int main(int argc, char** argv) {
                 renderer.drawPoint2D(sv.first, sv.second, 0.2f, 1.0f, 0.5f, 0.0f);
             }
 
+            renderer.setLayer(RenderLayer::Overlay);
             if (state.wallMode &&
                 state.selectedVertex >= 0 &&
                 state.hoveredVertex >= 0 &&
@@ -1798,49 +1993,120 @@ int main(int argc, char** argv) {
             renderer.drawLine2D(state.cursorX, state.cursorY - cursorSize,
                                 state.cursorX, state.cursorY + cursorSize,
                                 1.0f, 0.2f, 0.8f);
+            renderer.setLayer(RenderLayer::Auto);
             renderer.drawEditorHUD(state, winW, winH);
+            pacer.endWork();
             renderer.endFrame(window);
+            pacer.endFrame(renderer.lastPresentNs());
         } else {
-            renderer.drawMesh3D(state.worldMesh, fpsCamera);
-            for (const auto& p : state.projectiles.active) {
-                if (!p.alive) continue;
-                renderer.drawBillboard3D(fpsCamera, p.x, p.y, p.z, 0.35f, texProjSprite,
-                                         p.fromPlayer ? 0.8f : 0.2f,
-                                         p.fromPlayer ? 0.9f : 0.2f,
-                                         p.fromPlayer ? 1.0f : 0.1f);
+            // Sim state sits between the last two ticks; blend by the leftover time so motion stays smooth.
+            const uint64_t renderStartNs = PlatformTimeNs();
+            if (!replaying) {
+                latchLook(dt);
+            }
+            const float alpha = std::min(playAccumulator / kPlayTickDt, 1.0f);
+            auto lerp = [](float a, float b, float t) { return a + (b - a) * t; };
+            Camera3D view = fpsCamera;
+            view.x = lerp(prevCamera.x, fpsCamera.x, alpha);
+            view.y = lerp(prevCamera.y, fpsCamera.y, alpha);
+            view.z = lerp(prevCamera.z, fpsCamera.z, alpha);
+            float viewProj[16];
+            renderer.viewProjection(view, viewProj);
+            const float eye[3] = { view.x, view.y, view.z };
+            sectorsVisible = computeVisibleSectors(state.level, eye, viewProj, visibleSectors);
+            // Outside every sector (noclip into the void) there is no start portal; draw everything.
+            if (sectorsVisible > 0) {
+                bspSectorsFrontToBack(state.level.bsp, view.x, view.y, sectorScratch, sectorOrder);
+                sectorOrder.erase(std::remove_if(sectorOrder.begin(), sectorOrder.end(),
+                                                 [&](int s) { return !visibleSectors[s]; }),
+                                  sectorOrder.end());
+            }
+            renderer.drawMesh3D(state.worldMesh, view, sectorsVisible > 0 ? &sectorOrder : nullptr);
+            float moverOffsets[kMaxSectorMovers];
+            for (size_t m = 0; m < state.movers.size(); ++m)
+                moverOffsets[m] = lerp(state.movers[m].prevOffset, state.movers[m].offset, alpha);
+            renderer.setMoverOffsets(moverOffsets, state.movers.size());
+            doorProgress.resize(state.doors.size());
+            for (size_t d = 0; d < state.doors.size(); ++d)
+                doorProgress[d] = state.doors[d].active
+                    ? lerp(state.doors[d].prevProgress, state.doors[d].progress, alpha) : 1.0f;
+            renderer.setDoorProgress(doorProgress.data(), doorProgress.size());
+            const ProjectileSystem& shots = state.projectiles;
+            for (size_t i = 0; i < shots.count; ++i) {
+                const bool fromPlayer = shots.fromPlayer(i);
+                renderer.queueSprite(lerp(shots.prevX[i], shots.x[i], alpha),
+                                     lerp(shots.prevY[i], shots.y[i], alpha),
+                                     lerp(shots.prevZ[i], shots.z[i], alpha), 0.35f, texProjSprite,
+                                     fromPlayer ? 0.8f : 0.2f,
+                                     fromPlayer ? 0.9f : 0.2f,
+                                     fromPlayer ? 1.0f : 0.1f);
             }
             for (const auto& e : state.enemies) {
                 if (!e.alive) continue;
-                renderer.drawBillboard3D(fpsCamera, e.x, e.y, e.z, 1.2f, texEnemySprite,
-                                         1.0f, 1.0f, 1.0f);
-            }
-            for (const auto& d : state.doors) {
-                if (!d.active) continue;
-                constexpr float doorSpriteSize = 1.5f;
-                float z = (doorSpriteSize * 0.5f) + d.progress * d.height; // keep sprite base at floor
-                renderer.drawBillboard3D(fpsCamera, d.x, d.y, z, doorSpriteSize, texDoorSprite,
-                                         1.0f, 1.0f, 1.0f);
+                renderer.queueSprite(lerp(e.prevX, e.x, alpha), lerp(e.prevY, e.y, alpha), e.z, 1.2f, texEnemySprite,
+                                     1.0f, 1.0f, 1.0f);
             }
             for (const auto& it : state.items) {
                 if (!it.alive) continue;
-                renderer.drawBillboard3D(fpsCamera, it.x, it.y, it.z, 0.6f, texItemHealth, 1.0f, 1.0f, 1.0f);
+                renderer.queueSprite(it.x, it.y, it.z, 0.6f, texItemHealth, 1.0f, 1.0f, 1.0f);
             }
+            renderer.drawSprites(view);
             if (state.blockFlashTimer > 0.0f) {
                 // Push the flash slightly in front of the camera so it can't clip in the near plane.
-                const float cosYaw = std::cos(fpsCamera.yaw);
-                const float sinYaw = std::sin(fpsCamera.yaw);
-                const float cosPitch = std::cos(fpsCamera.pitch);
-                const float sinPitch = std::sin(fpsCamera.pitch);
+                const float cosYaw = std::cos(view.yaw);
+                const float sinYaw = std::sin(view.yaw);
+                const float cosPitch = std::cos(view.pitch);
+                const float sinPitch = std::sin(view.pitch);
                 const float forwardX = cosPitch * sinYaw;
                 const float forwardY = cosPitch * cosYaw;
                 const float forwardZ = sinPitch;
                 const float flashDist = 0.6f;
-                const float flashX = fpsCamera.x + forwardX * flashDist;
-                const float flashY = fpsCamera.y + forwardY * flashDist;
-                const float flashZ = fpsCamera.z + forwardZ * flashDist + 0.25f;
-                renderer.drawBillboard3D(fpsCamera, flashX, flashY, flashZ, 1.8f, texBlockFlash, 1.0f, 1.0f, 1.0f);
+                const float flashX = view.x + forwardX * flashDist;
+                const float flashY = view.y + forwardY * flashDist;
+                const float flashZ = view.z + forwardZ * flashDist + 0.25f;
+                renderer.drawBillboard3D(view, flashX, flashY, flashZ, 1.8f, texBlockFlash, 1.0f, 1.0f, 1.0f);
             }
+            pacer.endWork();
             renderer.endFrame(window);
+            pacer.endFrame(renderer.lastPresentNs());
+            if (replaying) {
+                const uint64_t endNs = PlatformTimeNs();
+                const float frameMs = static_cast<float>(endNs - now) * 1e-6f;
+                replayFrameMs.push_back(frameMs);
+                std::printf("replay frame %zu: ticks %d sim %.3f ms render %.3f ms frame %.3f ms\n",
+                            replayFrameMs.size(), ticks, simNs * 1e-6, (endNs - renderStartNs) * 1e-6, frameMs);
+            }
+            const uint64_t latencyNs = renderer.lastFrameStats().inputLatencyNs;
+            if (latencyNs > 0) {
+                latencySumNs += latencyNs;
+                latencyMaxNs = std::max(latencyMaxNs, latencyNs);
+                ++latencySamples;
+            }
+            if (printCullStats) {
+                cullStatsTimer += dt;
+                if (cullStatsTimer >= 1.0f) {
+                    cullStatsTimer = 0.0f;
+                    const RenderCullStats& cull = renderer.lastCullStats();
+                    std::printf("cull: sectors %zu/%zu chunks %zu/%zu sprites %zu/%zu\n",
+                                sectorsVisible, state.level.sectors.size(),
+                                cull.chunksVisible, cull.chunksTotal,
+                                cull.spritesVisible, cull.spritesTotal);
+                    if (latencySamples > 0) {
+                        std::printf("latency: input->swap avg %.2f ms max %.2f ms over %u frames, pacer work %.2f ms\n",
+                                    static_cast<double>(latencySumNs) / latencySamples * 1e-6,
+                                    static_cast<double>(latencyMaxNs) * 1e-6, latencySamples,
+                                    static_cast<double>(pacer.workEstimateNs()) * 1e-6);
+                    }
+                    if (state.playMode) {
+                        const SnapshotStats& snap = checkpoints.stats();
+                        std::printf("snapshots: %zu kept, last %zu bytes (peak %zu), capture %.1f us\n",
+                                    snap.records, snap.lastBytes, snap.peakBytes, snap.lastCaptureNs * 1e-3);
+                    }
+                    latencySumNs = 0;
+                    latencyMaxNs = 0;
+                    latencySamples = 0;
+                }
+            }
         }
     };
 
@@ -1855,6 +2121,11 @@ int main(int argc, char** argv) {
     }
 #endif
 
+    if (recorder.active()) {
+        recorder.finish(recordPath);
+    }
+    renderer.stopRenderThread();
+
     if (controller) {
         SDL_GameControllerClose(controller);
     }